@@ -0,0 +1,99 @@
+/**
+ * @file  DataEncoding.h
+ * @brief Binary and text encoders for the "/data" chart data streams
+ */
+
+#ifndef __DATA_ENCODING_H__
+#define __DATA_ENCODING_H__
+
+#include <stdint.h>
+#include <math.h>
+#include <ResponseWriter.h>
+
+#define DATA_BINARY_NULL   INT16_MIN       // Binary /data word for a missing value
+#define DATA_BINARY_ESCAPE (INT16_MIN + 1) // Binary /data word that precedes an absolute value
+
+// Each binary word is the change in the quantized stream value (value / scale) since the previous non-null element, or DATA_BINARY_NULL for a missing
+// value, or DATA_BINARY_ESCAPE followed by two words holding the absolute quantized value as an int32 (low word first). "previous" carries the last
+// quantized value from one call to the next, and starts at zero for each stream. Each element takes at most 3 words.
+
+// Append one quantized value, and return the number of words written
+inline int dataEncodeWord(int16_t* words, int32_t q, int32_t& previous)
+{
+  int32_t delta = q - previous;
+  previous = q;
+  if (delta > DATA_BINARY_ESCAPE && delta <= INT16_MAX)
+  {
+    words[0] = (int16_t)delta;
+    return 1;
+  }
+
+  // The change is too large for one word, so send the absolute value
+  words[0] = DATA_BINARY_ESCAPE;
+  words[1] = (int16_t)(q & 0xFFFF);
+  words[2] = (int16_t)((uint32_t)q >> 16);
+  return 3;
+}
+
+// Encode values with the specified resolution, and return the number of words written. Missing (non-finite) values are encoded as DATA_BINARY_NULL.
+inline int dataEncodeValues(int16_t* words, const float* values, int count, float scale, int32_t& previous)
+{
+  int n = 0;
+  for (int k = 0; k < count; k++)
+  {
+    if (!isfinite(values[k])) words[n++] = DATA_BINARY_NULL;
+    else n += dataEncodeWord(words + n, (int32_t)lroundf(values[k] / scale), previous);
+  }
+  return n;
+}
+
+// Encode time indexes, which are already whole seconds, and return the number of words written
+inline int dataEncodeTimes(int16_t* words, const int32_t* times, int count, int32_t& previous)
+{
+  int n = 0;
+  for (int k = 0; k < count; k++) n += dataEncodeWord(words + n, times[k], previous);
+  return n;
+}
+
+// Decode words back to values, such as for checking the encoder. Missing values are decoded as NAN. Returns the number of values decoded.
+inline int dataDecodeValues(const int16_t* words, int count, float scale, float* values)
+{
+  int32_t q = 0;
+  int n = 0;
+  for (int w = 0; w < count; w++)
+  {
+    if (words[w] == DATA_BINARY_NULL)
+    {
+      values[n++] = NAN;
+      continue;
+    }
+    if (words[w] == DATA_BINARY_ESCAPE && w + 2 < count)
+    {
+      q = (int32_t)((uint32_t)(uint16_t)words[w + 1] | ((uint32_t)(uint16_t)words[w + 2] << 16));
+      w += 2;
+    }
+    else
+    {
+      q += words[w];
+    }
+    values[n++] = q * scale;
+  }
+  return n;
+}
+
+// Format values for the text format as comma-terminated values with 2 decimal places. Missing values are sent as JavaScript NULL values.
+inline void dataFormatValues(ResponseWriter& out, const float* values, int count)
+{
+  for (int k = 0; k < count; k++)
+  {
+    if (!isfinite(values[k])) out.print("null,"); else out.printf("%0.2f,", values[k]);
+  }
+}
+
+// Format time indexes for the text format as comma-terminated integers
+inline void dataFormatTimes(ResponseWriter& out, const int32_t* times, int count)
+{
+  for (int k = 0; k < count; k++) out.printf("%d,", (int)times[k]);
+}
+
+#endif
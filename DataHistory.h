@@ -0,0 +1,211 @@
+/**
+ * @file  DataHistory.h
+ * @brief Binary ring buffer of sensor data streams for the web page charts
+ */
+
+#ifndef __DATA_HISTORY_H__
+#define __DATA_HISTORY_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// Each stream is a column of binary values in one shared block of memory, and appending a sample writes one slot per stream and advances
+// a single head index. Nothing is moved or formatted until the data is served. Missing values (such as IAQ during calibration) are stored as NAN.
+class DataHistory
+{
+  private:
+    float* values = nullptr;  // Column-major storage: stream N occupies values[N * capacity] through values[(N + 1) * capacity - 1]
+    int32_t* times = nullptr; // Time index column, in seconds of uptime
+    int capacity = 0;         // Number of elements per stream
+    int streamCount = 0;      // Number of value streams, not including the time index
+    int head = 0;             // Index of the next slot to be written in every stream
+    int count = 0;            // Number of valid elements in each stream
+    uint32_t total = 0;       // Number of elements ever appended, which is the sequence number of the next element
+
+    // Translate a logical element index (0 = oldest) to a physical slot index
+    inline int slot(int i) const
+    {
+      int s = head - count + i;
+      return s < 0 ? s + capacity : s;
+    }
+
+  public:
+    // Number of bytes needed to hold the specified number of elements for the specified number of value streams
+    static size_t memoryRequired(int elements, int streams)
+    {
+      return (size_t)elements * (streams * sizeof(float) + sizeof(int32_t));
+    }
+
+    // Attach a block of memory (typically PSRAM) of at least memoryRequired() bytes
+    bool begin(void* memory, int elements, int streams)
+    {
+      if (!memory || elements <= 0 || streams <= 0) return false;
+      values = (float*)memory;
+      times = (int32_t*)(values + (size_t)elements * streams);
+      capacity = elements;
+      streamCount = streams;
+      head = 0;
+      count = 0;
+      total = 0;
+      return true;
+    }
+
+    // True when memory has been attached
+    bool ready() const { return values != nullptr; }
+
+    // Number of valid elements in each stream
+    int size() const { return count; }
+
+    // Maximum number of elements in each stream
+    int maxSize() const { return capacity; }
+
+    // Number of value streams
+    int streams() const { return streamCount; }
+
+    // Sequence number of the oldest element. Unlike logical element indexes, sequence numbers don't change as new elements are appended.
+    uint32_t firstSequence() const { return total - count; }
+
+    // Logical element index of the specified sequence number, or -1 if that element has been overwritten or not appended yet
+    int indexOf(uint32_t sequence) const
+    {
+      uint32_t i = sequence - firstSequence();
+      return i < (uint32_t)count ? (int)i : -1;
+    }
+
+    // Append one sample to every stream, overwriting the oldest element when full. "sample" must hold one value per stream.
+    void append(int32_t time, const float* sample)
+    {
+      if (!values) return;
+      for (int s = 0; s < streamCount; s++)
+      {
+        values[(size_t)s * capacity + head] = sample[s];
+      }
+      times[head] = time;
+      head = head + 1 < capacity ? head + 1 : 0;
+      if (count < capacity) count++;
+      total++;
+    }
+
+    // Value of the specified stream at logical element index i, where 0 is the oldest element
+    float value(int stream, int i) const
+    {
+      return values[(size_t)stream * capacity + slot(i)];
+    }
+
+    // Time index at logical element index i, where 0 is the oldest element
+    int32_t time(int i) const
+    {
+      return times[slot(i)];
+    }
+};
+
+// Accumulates samples over a fixed period (such as 15 minutes) and appends the min/average/max of each stream to a rollup DataHistory tier when the
+// period ends. The tier must have DATA_ROLLUP_STATS columns per stream, where stream N uses columns N * 3 + 0/1/2 for min/average/max.
+// Each rollup element is stamped with the time index at the start of its period. Missing (NAN) samples are ignored. Periods start at multiples of
+// the period length in time index seconds, unless align() shifts them, such as to start the daily periods at midnight.
+#define DATA_ROLLUP_STATS 3
+#define DATA_ROLLUP_MIN   0
+#define DATA_ROLLUP_AVG   1
+#define DATA_ROLLUP_MAX   2
+class DataRollup
+{
+  private:
+    int streamCount;      // Number of value streams
+    int32_t period;       // Length of each period in seconds
+    int32_t start = 0;    // Time index at the start of the current period
+    int32_t phase = 0;    // Added to time indexes before rounding them down to a period boundary
+    bool started = false; // True once the first sample has been added
+    float* minimum;       // Per-stream min for the current period
+    float* maximum;       // Per-stream max for the current period
+    double* sum;          // Per-stream sum for the current period
+    int* count;           // Per-stream number of samples in the current period
+    float* stats;         // Work area for one rollup element
+
+    // Time index at the start of the period containing the specified time, rounding down for negative times too
+    int32_t periodStart(int32_t time) const
+    {
+      int32_t t = time + phase;
+      int32_t r = t % period;
+      return (r < 0 ? t - r - period : t - r) - phase;
+    }
+
+    // Clear the per-stream accumulators
+    void reset()
+    {
+      for (int s = 0; s < streamCount; s++)
+      {
+        minimum[s] = INFINITY;
+        maximum[s] = -INFINITY;
+        sum[s] = 0;
+        count[s] = 0;
+      }
+    }
+
+  public:
+    // Constructor
+    DataRollup(int streams, int32_t periodSeconds)
+    {
+      streamCount = streams;
+      period = periodSeconds;
+      minimum = new float[streams];
+      maximum = new float[streams];
+      sum = new double[streams];
+      count = new int[streams];
+      stats = new float[streams * DATA_ROLLUP_STATS];
+      reset();
+    }
+
+    // Destructor
+    ~DataRollup()
+    {
+      delete[] minimum;
+      delete[] maximum;
+      delete[] sum;
+      delete[] count;
+      delete[] stats;
+    }
+
+    // Start the periods where (time index + offset) is a multiple of the period length. For example, with the clock time at time index 0 plus the
+    // local UTC offset, the daily periods start at local midnight. Call this before the first sample is added.
+    void align(int64_t offset)
+    {
+      phase = (int32_t)(offset % period);
+    }
+
+    // Add one sample (one value per stream). If it starts a new period, the finished period is appended to the tier first.
+    void add(int32_t time, const float* sample, DataHistory& tier)
+    {
+      int32_t p = periodStart(time);
+      if (started && p != start) flush(tier);
+      if (!started || p != start)
+      {
+        start = p;
+        started = true;
+      }
+      for (int s = 0; s < streamCount; s++)
+      {
+        float v = sample[s];
+        if (!isfinite(v)) continue;
+        if (v < minimum[s]) minimum[s] = v;
+        if (v > maximum[s]) maximum[s] = v;
+        sum[s] += v;
+        count[s]++;
+      }
+    }
+
+    // Append the current period to the tier and start over
+    void flush(DataHistory& tier)
+    {
+      for (int s = 0; s < streamCount; s++)
+      {
+        stats[s * DATA_ROLLUP_STATS + DATA_ROLLUP_MIN] = count[s] ? minimum[s] : NAN;
+        stats[s * DATA_ROLLUP_STATS + DATA_ROLLUP_AVG] = count[s] ? (float)(sum[s] / count[s]) : NAN;
+        stats[s * DATA_ROLLUP_STATS + DATA_ROLLUP_MAX] = count[s] ? maximum[s] : NAN;
+      }
+      tier.append(start, stats);
+      reset();
+    }
+};
+
+#endif
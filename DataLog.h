@@ -0,0 +1,218 @@
+/**
+ * @file  DataLog.h
+ * @brief Append-only flash log of data samples, so the data history can be restored after a reboot
+ */
+
+#ifndef __DATA_LOG_H__
+#define __DATA_LOG_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <FS.h>
+
+#define DATA_LOG_MAGIC      0x474C4441 // "ADLG"
+#define DATA_LOG_VERSION    1
+#define DATA_LOG_READ_BATCH 64 // Number of records read from flash at a time during a restore
+
+// Samples are stamped with epoch seconds and appended to one of two segment files. When the active segment holds the specified number of records, the
+// other segment is truncated and becomes the active one, so the log always holds at least one full segment of the newest records. Records are
+// collected in memory and written in batches to limit flash wear, and the file system does the wear levelling. Each segment starts with a header,
+// so a log written with a different number of streams is ignored. Records that couldn't be written stay in the batch and are retried with the next
+// one, and when the batch is still full, the oldest record is dropped to make room.
+class DataLog
+{
+  private:
+    struct Header
+    {
+      uint32_t magic;
+      uint16_t version;
+      uint16_t streams;
+      uint32_t sequence; // Incremented each time a segment is started, so the newer segment can be found
+    };
+
+    fs::FS* fs = nullptr;
+    const char* paths[2];     // Segment file paths
+    int streamCount;          // Number of value streams per record
+    int segmentRecords;       // Number of records per segment
+    int batchRecords;         // Number of records collected in memory before they are written
+    uint8_t* batch;           // Records waiting to be written
+    int batchCount = 0;       // Number of records waiting to be written
+    int active = 0;           // Index of the segment being appended to
+    uint32_t sequence = 0;    // Sequence number of the active segment
+    int activeCount = 0;      // Number of records in the active segment
+    uint32_t failures = 0;    // Number of failed segment writes
+    uint32_t dropped = 0;     // Number of records dropped because the batch was full of records that couldn't be written
+
+    // Bytes per record: epoch time followed by one float per stream
+    size_t recordSize() const { return sizeof(uint32_t) + streamCount * sizeof(float); }
+
+    // Read a segment header, and return the number of whole records in the segment, or -1 if the segment is missing or doesn't match
+    int readSegment(int segment, Header& header, bool& aligned)
+    {
+      File file = fs->open(paths[segment], "r");
+      if (!file) return -1;
+      bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                header.magic == DATA_LOG_MAGIC && header.version == DATA_LOG_VERSION && header.streams == streamCount;
+      size_t bytes = file.size() - sizeof(header);
+      file.close();
+      if (!ok) return -1;
+      aligned = bytes % recordSize() == 0; // A partial record at the end means a write was interrupted
+      return (int)(bytes / recordSize());
+    }
+
+    // Truncate a segment and make it the active one
+    void startSegment(int segment)
+    {
+      Header header = { DATA_LOG_MAGIC, DATA_LOG_VERSION, (uint16_t)streamCount, ++sequence };
+      File file = fs->open(paths[segment], "w");
+      if (file)
+      {
+        file.write((const uint8_t*)&header, sizeof(header));
+        file.close();
+      }
+      active = segment;
+      activeCount = 0;
+    }
+
+    // Copy records from a segment to the reader, starting at the specified record index
+    template <typename Reader>
+    int readRecords(int segment, int first, int count, Reader reader)
+    {
+      File file = fs->open(paths[segment], "r");
+      if (!file) return 0;
+      size_t size = recordSize();
+      uint8_t* buffer = (uint8_t*)malloc(DATA_LOG_READ_BATCH * size);
+      int done = 0;
+      if (buffer && file.seek(sizeof(Header) + first * size))
+      {
+        while (done < count)
+        {
+          int n = count - done < DATA_LOG_READ_BATCH ? count - done : DATA_LOG_READ_BATCH;
+          if (file.read(buffer, n * size) != n * size) break;
+          for (int i = 0; i < n; i++)
+          {
+            const uint8_t* record = buffer + i * size;
+            reader(*(const uint32_t*)record, (const float*)(record + sizeof(uint32_t)));
+          }
+          done += n;
+        }
+      }
+      free(buffer);
+      file.close();
+      return done;
+    }
+
+  public:
+    // Constructor
+    DataLog(int streams, int recordsPerSegment, int recordsPerBatch)
+    {
+      streamCount = streams;
+      segmentRecords = recordsPerSegment;
+      batchRecords = recordsPerBatch > 0 ? recordsPerBatch : 1;
+      batch = (uint8_t*)malloc(batchRecords * recordSize());
+    }
+
+    // Destructor
+    ~DataLog()
+    {
+      free(batch);
+    }
+
+    // Open the log on a mounted file system, and find the segment to append to
+    bool begin(fs::FS& fileSystem, const char* path0, const char* path1)
+    {
+      fs = &fileSystem;
+      paths[0] = path0;
+      paths[1] = path1;
+      Header header[2];
+      bool aligned[2] = { true, true };
+      int count[2] = { readSegment(0, header[0], aligned[0]), readSegment(1, header[1], aligned[1]) };
+      if (count[0] < 0 && count[1] < 0)
+      {
+        startSegment(0); // New log
+        return batch != nullptr;
+      }
+
+      // Continue with the newer segment, unless it's full or ends with a partial record
+      int newer = count[1] >= 0 && (count[0] < 0 || (int32_t)(header[1].sequence - header[0].sequence) > 0) ? 1 : 0;
+      sequence = header[newer].sequence;
+      active = newer;
+      activeCount = count[newer];
+      if (activeCount >= segmentRecords || !aligned[newer]) startSegment(newer ^ 1);
+      return batch != nullptr;
+    }
+
+    // Pass up to the specified number of the newest records to the reader, oldest first, as reader(uint32_t time, const float* sample).
+    // Returns the number of records read. Call this before appending any records.
+    template <typename Reader>
+    int restore(int limit, Reader reader)
+    {
+      if (!fs) return 0;
+      Header header;
+      bool aligned;
+      int older = active ^ 1;
+      int olderCount = readSegment(older, header, aligned);
+      if (olderCount < 0 || header.sequence != sequence - 1) olderCount = 0; // Missing, or not the segment before the active one
+      int fromActive = activeCount < limit ? activeCount : limit;
+      int fromOlder = olderCount < limit - fromActive ? olderCount : limit - fromActive;
+      int n = 0;
+      if (fromOlder > 0) n += readRecords(older, olderCount - fromOlder, fromOlder, reader);
+      if (fromActive > 0) n += readRecords(active, activeCount - fromActive, fromActive, reader);
+      return n;
+    }
+
+    // Add one record, which is written to flash when the batch is full. "sample" must hold one value per stream.
+    void append(uint32_t time, const float* sample)
+    {
+      if (!fs || !batch) return;
+      if (batchCount >= batchRecords)
+      {
+        memmove(batch, batch + recordSize(), (batchCount - 1) * recordSize()); // Writes are failing, so make room by dropping the oldest record
+        batchCount--;
+        dropped++;
+      }
+      uint8_t* record = batch + batchCount * recordSize();
+      *(uint32_t*)record = time;
+      memcpy(record + sizeof(uint32_t), sample, streamCount * sizeof(float));
+      if (++batchCount >= batchRecords) flush();
+    }
+
+    // Write the records collected so far, starting a new segment as needed. Records that couldn't be written are kept for the next flush().
+    void flush()
+    {
+      if (!fs || !batch) return;
+      size_t size = recordSize();
+      int written = 0;
+      while (written < batchCount)
+      {
+        if (activeCount >= segmentRecords) startSegment(active ^ 1);
+        int n = batchCount - written;
+        if (n > segmentRecords - activeCount) n = segmentRecords - activeCount;
+        File file = fs->open(paths[active], "a");
+        if (!file)
+        {
+          failures++;
+          break;
+        }
+        size_t bytes = file.write(batch + written * size, n * size);
+        file.close();
+        activeCount += bytes / size;
+        written += bytes / size;
+        if (bytes != n * size)
+        {
+          failures++;
+          if (bytes % size) activeCount = segmentRecords; // A partial record would misalign the rest of the segment, so start the other one next time
+          break;
+        }
+      }
+      batchCount -= written;
+      if (batchCount) memmove(batch, batch + written * size, batchCount * size);
+    }
+
+    // Number of failed segment writes, and the number of records dropped because the writes kept failing
+    uint32_t writeFailures() const { return failures; }
+    uint32_t droppedRecords() const { return dropped; }
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file  Instrumentation.h
+ * @brief Latency histograms and task load counters for the Prometheus "/metrics" endpoint (see MetricsWriter.h for the output)
+ */
+
+#ifndef __INSTRUMENTATION_H__
+#define __INSTRUMENTATION_H__
+
+#include <stdint.h>
+#include <ResponseWriter.h>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <esp_timer.h>
+  #define INSTRUMENTATION_MICROS() ((int64_t)esp_timer_get_time())
+#else
+  #include <chrono>
+  #define INSTRUMENTATION_MICROS() ((int64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+#endif
+
+#define INSTRUMENTATION_BUCKETS 14 // Number of histogram buckets, not including +Inf
+
+// Fixed-bucket latency histogram in microseconds, with bucket bounds from 100us to 5s. Values can be recorded from any task, since the counters are
+// updated atomically. A scrape can see a value in the sum but not yet in a bucket, which Prometheus tolerates.
+class LatencyHistogram
+{
+  private:
+    uint32_t counts[INSTRUMENTATION_BUCKETS + 1] = {}; // Per-bucket counts, where the last bucket is +Inf
+    uint64_t sum = 0;                                   // Sum of all recorded values in microseconds
+
+  public:
+    // Upper bound of each bucket in microseconds
+    static constexpr uint32_t bounds[INSTRUMENTATION_BUCKETS] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 5000000 };
+
+    // Record one value
+    void record(int64_t micros)
+    {
+      if (micros < 0) micros = 0;
+      int b = 0;
+      while (b < INSTRUMENTATION_BUCKETS && (uint64_t)micros > bounds[b]) b++;
+      __atomic_fetch_add(&counts[b], 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&sum, (uint64_t)micros, __ATOMIC_RELAXED);
+    }
+
+    // Copy the cumulative bucket counts, where the last one is +Inf, and return the total count
+    uint32_t cumulative(uint32_t* buckets) const
+    {
+      uint32_t total = 0;
+      for (int b = 0; b <= INSTRUMENTATION_BUCKETS; b++)
+      {
+        total += __atomic_load_n(&counts[b], __ATOMIC_RELAXED);
+        buckets[b] = total;
+      }
+      return total;
+    }
+
+    // Sum of all recorded values in seconds
+    double sumSeconds() const { return __atomic_load_n(&sum, __ATOMIC_RELAXED) / 1e6; }
+};
+
+// Records the time from construction to destruction, such as the duration of a function, in a histogram
+class LatencyTimer
+{
+  private:
+    LatencyHistogram& histogram;
+    int64_t start;
+
+  public:
+    LatencyTimer(LatencyHistogram& h) : histogram(h), start(INSTRUMENTATION_MICROS()) {}
+    ~LatencyTimer() { histogram.record(INSTRUMENTATION_MICROS() - start); }
+};
+
+// Busy time of a task, which is the wall-clock time from the start to the end of each unit of work. That includes any blocking waits inside the work,
+// such as a sensor conversion delay or a socket write, so it's the time the task was occupied rather than the CPU time it used (see RunTimeShare).
+class TaskLoad
+{
+  private:
+    uint64_t busy = 0;        // Total busy time in microseconds, updated by the task being measured
+    int64_t start = 0;        // Start of the current busy period
+
+  public:
+    // Mark the start and end of a busy period in the measured task
+    void begin() { start = INSTRUMENTATION_MICROS(); }
+    void end() { __atomic_fetch_add(&busy, (uint64_t)(INSTRUMENTATION_MICROS() - start), __ATOMIC_RELAXED); }
+
+    // Total busy time in seconds
+    double busySeconds() const { return __atomic_load_n(&busy, __ATOMIC_RELAXED) / 1e6; }
+};
+
+// CPU use of a task from the FreeRTOS run-time counters, which only count the time the task was actually running on a core. The share is calculated
+// between two calls to update(), so only one task (the web server, for "/metrics") should call that. The counters can be 32 bits, so the differences
+// are taken modulo 2^32, which is correct as long as the calls are less than one counter wrap apart (71 minutes with a microsecond clock).
+class RunTimeShare
+{
+  private:
+    uint32_t lastTask = 0;  // Task run-time counter at the last update() call
+    uint32_t lastTotal = 0; // Run-time clock at the last update() call
+
+  public:
+    // Percentage of one CPU core used by the task since the last call (or since boot for the first call)
+    float update(uint32_t taskRunTime, uint32_t totalRunTime)
+    {
+      uint32_t task = taskRunTime - lastTask, total = totalRunTime - lastTotal;
+      lastTask = taskRunTime;
+      lastTotal = totalRunTime;
+      return total ? (float)task * 100.0F / (float)total : 0;
+    }
+};
+
+#endif
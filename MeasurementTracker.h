@@ -1,50 +1,460 @@
 /**
  * @file  MeasurementTracker.h
- * @brief Helper class to track sensor measurements with min, average and max calculations
+ * @brief Helper class to track sensor measurements with min, average and max calculations, and optional streaming summary operators
  */
 
 #ifndef __MEASUREMENT_TRACKER_H__
 #define __MEASUREMENT_TRACKER_H__
 
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#define MEASUREMENT_PACKED_NULL INT16_MIN // Packed data point for a missing (NAN) value
+
+// Optional summary values of a MeasurementTracker, each updated in constant time and memory per data point
+enum MeasurementSummary
+{
+  MEASUREMENT_SUMMARY_EMA,    // Exponential moving average, with a time constant of one window
+  MEASUREMENT_SUMMARY_P50,    // Median of the newest half to full window of data points
+  MEASUREMENT_SUMMARY_P95,    // 95th percentile of the newest half to full window of data points
+  MEASUREMENT_SUMMARY_STDDEV, // Standard deviation of the window
+  MEASUREMENT_SUMMARY_RATE,   // Rate of change, as the change per window length between the oldest and newest data points
+  MEASUREMENT_SUMMARY_VALUES  // Number of summary values
+};
+
+// Operator flags for the MeasurementTracker constructors, which select the summary values to calculate
+#define MEASUREMENT_EMA       (1 << MEASUREMENT_SUMMARY_EMA)
+#define MEASUREMENT_QUANTILES ((1 << MEASUREMENT_SUMMARY_P50) | (1 << MEASUREMENT_SUMMARY_P95))
+#define MEASUREMENT_STDDEV    (1 << MEASUREMENT_SUMMARY_STDDEV)
+#define MEASUREMENT_RATE      (1 << MEASUREMENT_SUMMARY_RATE)
+
+// Plain copy of the values from a MeasurementTracker, such as for sharing between tasks
+struct MeasurementStats
+{
+  float current, min, max, average;
+  uint8_t operators;                       // Operator flags, where bit n is set when summary[n] is calculated
+  float summary[MEASUREMENT_SUMMARY_VALUES]; // Summary values, indexed by MeasurementSummary, which are NAN when not calculated
+};
+
+// Exponential moving average, where each new value has a weight of 1 / samples. The first value initializes the average.
+class ExponentialAverage
+{
+  private:
+    float weight;
+
+  public:
+    float value = NAN; // Current average, or NAN before the first value
+
+    // Constructor
+    ExponentialAverage(float samples) : weight(samples > 1 ? 1.0F / samples : 1.0F) {}
+
+    // Add a value, and return the new average
+    float add(float x)
+    {
+      value = isnan(value) ? x : value + (x - value) * weight;
+      return value;
+    }
+};
+
+// Streaming quantile estimate with the P-square algorithm (Jain and Chlamtac, 1985), which keeps five markers instead of the values. The middle marker
+// tracks the quantile, and the others track the min, max and the halfway quantiles on either side. Markers are moved by piecewise-parabolic steps.
+class QuantileEstimator
+{
+  private:
+    float p;         // Quantile, from 0 to 1
+    int count = 0;   // Number of values added
+    float q[5];      // Marker heights
+    float n[5];      // Marker positions
+    float target[5]; // Desired marker positions
+
+    // Parabolic and linear predictions for moving marker i by d (+1 or -1)
+    float parabolic(int i, float d) const
+    {
+      return q[i] + d / (n[i + 1] - n[i - 1]) * ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) + (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    }
+    float linear(int i, int d) const
+    {
+      return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+    }
+
+  public:
+    // Constructor
+    QuantileEstimator(float quantile) : p(quantile) {}
+
+    // Forget all values
+    void reset() { count = 0; }
+
+    // Add a value
+    void add(float x)
+    {
+      // The first five values become the markers
+      if (count < 5)
+      {
+        int i = count++;
+        while (i > 0 && q[i - 1] > x) { q[i] = q[i - 1]; i--; } // Insertion sort
+        q[i] = x;
+        if (count == 5)
+        {
+          for (int k = 0; k < 5; k++) n[k] = k;
+          target[0] = 0; target[1] = 2 * p; target[2] = 4 * p; target[3] = 2 + 2 * p; target[4] = 4;
+        }
+        return;
+      }
+
+      // Find the cell holding the value, and move the markers above it
+      int k;
+      if (x < q[0]) { q[0] = x; k = 0; }
+      else if (x >= q[4]) { q[4] = x; k = 3; }
+      else { k = 0; while (x >= q[k + 1]) k++; }
+      for (int i = k + 1; i < 5; i++) n[i]++;
+      const float step[5] = { 0, p / 2, p, (1 + p) / 2, 1 };
+      for (int i = 0; i < 5; i++) target[i] += step[i];
+      count++;
+
+      // Adjust the middle markers that are off their desired positions
+      for (int i = 1; i <= 3; i++)
+      {
+        float d = target[i] - n[i];
+        if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1))
+        {
+          int s = d > 0 ? 1 : -1;
+          float h = parabolic(i, s);
+          q[i] = q[i - 1] < h && h < q[i + 1] ? h : linear(i, s);
+          n[i] += s;
+        }
+      }
+    }
+
+    // Current estimate, or NAN before the first value. Until there are five values, the nearest-rank quantile of the values is used.
+    float value() const
+    {
+      if (count == 0) return NAN;
+      if (count < 5) return q[(int)(p * (count - 1) + 0.5F)];
+      return q[2];
+    }
+};
+
+class MeasurementTracker;
+
+// Shared block of memory for the MeasurementTracker arrays, such as one PSRAM allocation. Trackers that are constructed with an arena add themselves to
+// its list and get their arrays when begin() is called, so the arena must be constructed before them. Memory is never returned to the arena.
+class MeasurementArena
+{
+  private:
+    MeasurementTracker* first = nullptr; // Trackers waiting for memory, in construction order
+    uint8_t* memory = nullptr;           // The block
+    size_t size = 0;                     // Bytes in the block
+    size_t used = 0;                     // Bytes handed out so far
+
+  public:
+    // Add a tracker to the list, which is done by the MeasurementTracker constructor
+    void add(MeasurementTracker* tracker);
+
+    // Total bytes needed by the trackers in the list
+    size_t memoryRequired() const;
+
+    // Allocate the arrays of every tracker in the list from the block. Arrays that don't fit (or all of them, when the block is null) are allocated
+    // from the heap instead. Call this before any of the trackers are used.
+    void begin(void* block, size_t bytes);
+
+    // Allocate 4-byte aligned memory from the block, or return null if it doesn't fit
+    void* allocate(size_t bytes)
+    {
+      bytes = (bytes + 3) & ~(size_t)3;
+      if (!memory || used + bytes > size) return nullptr;
+      void* p = memory + used;
+      used += bytes;
+      return p;
+    }
+
+    // Bytes handed out from the block, and bytes left
+    size_t bytesUsed() const { return used; }
+    size_t bytesFree() const { return memory ? size - used : 0; }
+};
+
 class MeasurementTracker
 {
+  friend class MeasurementArena;
+
   private:
-    float* data; // Array of data points
+    float* data = nullptr; // Array of data points, or null when the data points are packed
+    int16_t* packed = nullptr; // Array of data points as 16-bit fixed point, when a resolution is set
+    float resolution = 0; // Fixed point resolution, or 0 for float data points
+    float offset = 0; // Value of a packed zero, which centers the fixed point range on the expected values
     int dataSize = 0; // Number of data points
     int cursor = 0; // Current index into the data array
     bool dataFull = false; // Set to true when the cursor wraps around and the array is full of data
 
+    // Incremental mode state. The running sum is refreshed from the data array each time the cursor wraps around to correct floating point drift.
+    // The min/max values come from monotonic deques of data array indexes, where the front of each deque is the current min/max of the window.
+    bool incremental = false; // True when min/max/average are maintained incrementally instead of rescanning the data array
+    double runningSum = 0;    // Running sum of all data points in the window
+    uint16_t* minQueue = nullptr; // Ring buffer of data indexes with increasing values
+    uint16_t* maxQueue = nullptr; // Ring buffer of data indexes with decreasing values
+    int minHead = 0, minCount = 0;
+    int maxHead = 0, maxCount = 0;
+    bool owned = true;            // True when the arrays were allocated with new, and are deleted by the destructor
+
+    // Summary operator state. There are two sets of quantile estimators, which each restart once per window length, staggered by half a window. The
+    // set with more data points is reported, so the quantiles are always live and only cover data points that are still in the window.
+    uint8_t operators = 0;          // Operator flags
+    double runningSquares = 0;      // Running sum of the squares of all data points in the window, like runningSum
+    ExponentialAverage ema = ExponentialAverage(1);
+    QuantileEstimator p50[2] = { QuantileEstimator(0.50F), QuantileEstimator(0.50F) };
+    QuantileEstimator p95[2] = { QuantileEstimator(0.95F), QuantileEstimator(0.95F) };
+    int quantilePoints[2] = { 0, 0 }; // Data points seen by each set since it restarted, where a negative count is a delayed start
+    MeasurementTracker* nextInArena = nullptr; // Next tracker in the arena list
+
+    // Bytes needed for the arrays
+    size_t memoryRequired() const
+    {
+      size_t bytes = dataSize * (resolution > 0 ? sizeof(int16_t) : sizeof(float));
+      bytes = (bytes + 3) & ~(size_t)3;
+      if (incremental) bytes += 2 * (((dataSize * sizeof(uint16_t)) + 3) & ~(size_t)3);
+      return bytes;
+    }
+
+    // Allocate the arrays from the arena, or from the heap if the arena is full
+    void allocate(MeasurementArena& arena)
+    {
+      size_t dataBytes = dataSize * (resolution > 0 ? sizeof(int16_t) : sizeof(float));
+      size_t queueBytes = dataSize * sizeof(uint16_t);
+      if (memoryRequired() <= arena.bytesFree())
+      {
+        owned = false;
+        if (resolution > 0) packed = (int16_t*)arena.allocate(dataBytes); else data = (float*)arena.allocate(dataBytes);
+        if (incremental)
+        {
+          minQueue = (uint16_t*)arena.allocate(queueBytes);
+          maxQueue = (uint16_t*)arena.allocate(queueBytes);
+        }
+        return;
+      }
+      allocateHeap();
+    }
+
+    // Allocate the arrays with new
+    void allocateHeap()
+    {
+      owned = true;
+      if (resolution > 0) packed = new int16_t[dataSize]; else data = new float[dataSize];
+      minQueue = incremental ? new uint16_t[dataSize] : nullptr;
+      maxQueue = incremental ? new uint16_t[dataSize] : nullptr;
+    }
+
+    // Read one data point
+    float value(int index) const
+    {
+      if (!packed) return data[index];
+      int16_t q = packed[index];
+      return q == MEASUREMENT_PACKED_NULL ? NAN : offset + q * resolution;
+    }
+
+    // Store one data point, and return the stored value, which is rounded to the resolution and clamped to the fixed point range for packed data points
+    float store(int index, float dataPoint)
+    {
+      if (!packed)
+      {
+        data[index] = dataPoint;
+        return dataPoint;
+      }
+      int16_t q;
+      if (isnan(dataPoint)) q = MEASUREMENT_PACKED_NULL;
+      else
+      {
+        float scaled = (dataPoint - offset) / resolution;
+        q = scaled >= INT16_MAX ? INT16_MAX : scaled <= -INT16_MAX ? -INT16_MAX : (int16_t)lroundf(scaled);
+      }
+      packed[index] = q;
+      return value(index);
+    }
+
+    // Compute the sum of all data points in the window, and the sum of their squares
+    double rescanSum(int j, double& squares)
+    {
+      double s = 0;
+      squares = 0;
+      for (int i = 0; i < j; i++)
+      {
+        double v = value(i);
+        s += v;
+        squares += v * v;
+      }
+      return s;
+    }
+
+    // Update the summary operators with the stored data point, once the cursor has moved past it. "sum" and "squares" are the window sums.
+    void summarize(float stored, int j, double sum, double squares)
+    {
+      if (isfinite(stored))
+      {
+        if (operators & MEASUREMENT_EMA) ema.add(stored);
+      }
+      if (operators & MEASUREMENT_QUANTILES)
+      {
+        for (int k = 0; k < 2; k++)
+        {
+          if (quantilePoints[k] >= dataSize)
+          {
+            // The oldest data point of this set is leaving the window
+            p50[k].reset();
+            p95[k].reset();
+            quantilePoints[k] = 0;
+          }
+          if (quantilePoints[k] >= 0 && isfinite(stored))
+          {
+            p50[k].add(stored);
+            p95[k].add(stored);
+          }
+          quantilePoints[k]++;
+        }
+      }
+      if (operators & MEASUREMENT_STDDEV)
+      {
+        double mean = sum / j;
+        double variance = squares / j - mean * mean;
+        stddev = variance > 0 ? (float)sqrt(variance) : 0;
+      }
+      if (operators & MEASUREMENT_RATE)
+      {
+        float oldest = value(dataFull ? cursor : 0);
+        rate = j > 1 ? (stored - oldest) / (j - 1) * dataSize : NAN;
+      }
+    }
+
+    // Remove the oldest data point from the deques when it is about to be overwritten
+    void expire(int index)
+    {
+      if (minCount && minQueue[minHead] == index) { minHead = (minHead + 1) % dataSize; minCount--; }
+      if (maxCount && maxQueue[maxHead] == index) { maxHead = (maxHead + 1) % dataSize; maxCount--; }
+    }
+
+    // Add the newest data point to the deques, discarding any older points that can no longer become the min/max
+    void admit(int index, float dataPoint)
+    {
+      while (minCount && value(minQueue[(minHead + minCount - 1) % dataSize]) >= dataPoint) minCount--;
+      minQueue[(minHead + minCount) % dataSize] = index;
+      minCount++;
+      while (maxCount && value(maxQueue[(maxHead + maxCount - 1) % dataSize]) <= dataPoint) maxCount--;
+      maxQueue[(maxHead + maxCount) % dataSize] = index;
+      maxCount++;
+    }
+
   public:
     float current; // Current value for the metric, which is also at data[cursor]
     float min, max, average; // Statistics about the data in the array, updated each time new data points are added
+    float stddev = NAN, rate = NAN; // Summary values, when the operators are enabled
 
-    // Constructor
-    MeasurementTracker(int dataArraySize)
+    // Constructor. Incremental mode makes track() amortized O(1) and is used unless the array is too large for 16-bit deque indexes.
+    // The operator flags (MEASUREMENT_EMA etc.) select the summary values.
+    MeasurementTracker(int dataArraySize, bool incrementalMode = true, uint8_t operatorFlags = 0)
     {
-      // Allocate memory for data array
-      data = new float[dataArraySize];
       dataSize = dataArraySize;
-      dataFull = false;
-      cursor = 0;
+      incremental = incrementalMode && dataArraySize <= 65536;
+      operators = operatorFlags;
+      ema = ExponentialAverage(dataArraySize);
+      quantilePoints[1] = -(dataArraySize / 2); // The second set of quantile estimators starts half a window later
+      allocateHeap();
+    }
+
+    // Constructor for a tracker with its arrays in an arena, which are allocated by MeasurementArena::begin(). When fixedResolution is more than zero,
+    // data points are stored as 16-bit fixed point values of (value - fixedOffset) / fixedResolution, which halves the size of the data array. The
+    // min/max/average values are then calculated from the rounded data points, and values outside of the fixed point range are clamped.
+    MeasurementTracker(int dataArraySize, MeasurementArena& arena, float fixedResolution = 0, float fixedOffset = 0, uint8_t operatorFlags = 0)
+    {
+      dataSize = dataArraySize;
+      incremental = dataArraySize <= 65536;
+      operators = operatorFlags;
+      ema = ExponentialAverage(dataArraySize);
+      quantilePoints[1] = -(dataArraySize / 2); // The second set of quantile estimators starts half a window later
+      resolution = fixedResolution > 0 ? fixedResolution : 0;
+      offset = fixedOffset;
+      arena.add(this);
     }
 
     // Destructor
     ~MeasurementTracker()
     {
       // Free memory
-      delete[] data;
+      if (owned)
+      {
+        delete[] data;
+        delete[] packed;
+        delete[] minQueue;
+        delete[] maxQueue;
+      }
       data = nullptr;
+      packed = nullptr;
+      minQueue = maxQueue = nullptr;
       dataSize = 0;
     }
 
+    // Number of data points in the window
+    int size() const { return dataSize; }
+
+    // Current/min/max/average values as a plain struct
+    MeasurementStats stats() const
+    {
+      MeasurementStats s = { current, min, max, average, operators, { NAN, NAN, NAN, NAN, NAN } };
+      if (operators & MEASUREMENT_EMA) s.summary[MEASUREMENT_SUMMARY_EMA] = ema.value;
+      if (operators & MEASUREMENT_QUANTILES)
+      {
+        int k = quantilePoints[1] > quantilePoints[0] ? 1 : 0;
+        s.summary[MEASUREMENT_SUMMARY_P50] = p50[k].value();
+        s.summary[MEASUREMENT_SUMMARY_P95] = p95[k].value();
+      }
+      if (operators & MEASUREMENT_STDDEV) s.summary[MEASUREMENT_SUMMARY_STDDEV] = stddev;
+      if (operators & MEASUREMENT_RATE) s.summary[MEASUREMENT_SUMMARY_RATE] = rate;
+      return s;
+    }
+
     // Track a new data point and recompute min/max/average values
     void track(float dataPoint)
     {
+      // Missing (NAN) or infinite readings are dropped, since they would poison the sums and can't be ordered in the min/max deques
+      if (!isfinite(dataPoint)) return;
+
       // Capture the current value
       current = dataPoint;
 
+      if (incremental)
+      {
+        // Retire the data point being overwritten
+        bool resum = false;
+        if (dataFull)
+        {
+          float expired = value(cursor);
+          runningSum -= expired;
+          runningSquares -= (double)expired * expired;
+          expire(cursor);
+        }
+
+        // Add the new data point to the tracking array, the running sum and the deques
+        float stored = store(cursor, dataPoint);
+        runningSum += stored;
+        runningSquares += (double)stored * stored;
+        admit(cursor, stored);
+        cursor++;
+        if (cursor >= dataSize)
+        {
+          cursor = 0; // Wrap around
+          dataFull = true;
+          resum = true; // Drift correction, once per pass through the array
+        }
+
+        // Read the statistics from the running state
+        int j = dataFull ? dataSize : cursor;
+        if (resum) runningSum = rescanSum(j, runningSquares);
+        min = value(minQueue[minHead]);
+        max = value(maxQueue[maxHead]);
+        average = (float)(runningSum / (double)j);
+        if (operators) summarize(stored, j, runningSum, runningSquares);
+        return;
+      }
+
       // Add a new data point to the tracking array
-      data[cursor] = dataPoint;
+      float stored = store(cursor, dataPoint);
       cursor++;
       if (cursor >= dataSize)
       {
@@ -54,18 +464,67 @@ class MeasurementTracker
 
       // Compute min/max/average values from the data array
       int j = dataFull ? dataSize : cursor;
-      min = data[0];
-      max = data[0];
-      double sum = data[0];
+      min = value(0);
+      max = min;
+      double sum = min;
+      double squares = (double)min * min;
       for (int i = 1; i < j; i++)
       {
-        float d = data[i];
+        float d = value(i);
         if (d < min) min = d;
         if (d > max) max = d;
         sum += d;
+        squares += (double)d * d;
       }
       average = (float)(sum / (double)j);
+      if (operators) summarize(stored, j, sum, squares);
+    }
+
+    // Track the same data point several times, such as a restored sample that stands for several readings. Without incremental mode, only the last
+    // one rescans the data array.
+    void track(float dataPoint, int repeats)
+    {
+      if (!isfinite(dataPoint)) return;
+      if (incremental)
+      {
+        for (int k = 0; k < repeats; k++) track(dataPoint);
+        return;
+      }
+      for (int k = 1; k < repeats; k++)
+      {
+        float stored = store(cursor, dataPoint);
+        cursor++;
+        if (cursor >= dataSize)
+        {
+          cursor = 0; // Wrap around
+          dataFull = true;
+        }
+        if (operators) summarize(stored, dataFull ? dataSize : cursor, 0, 0); // The standard deviation is redone by the last track()
+      }
+      if (repeats > 0) track(dataPoint);
     }
 };
 
+inline void MeasurementArena::add(MeasurementTracker* tracker)
+{
+  MeasurementTracker** link = &first;
+  while (*link) link = &(*link)->nextInArena;
+  *link = tracker;
+}
+
+inline size_t MeasurementArena::memoryRequired() const
+{
+  size_t bytes = 0;
+  for (MeasurementTracker* t = first; t; t = t->nextInArena) bytes += t->memoryRequired();
+  return bytes;
+}
+
+inline void MeasurementArena::begin(void* block, size_t bytes)
+{
+  memory = (uint8_t*)block;
+  size = block ? bytes : 0;
+  used = 0;
+  for (MeasurementTracker* t = first; t; t = t->nextInArena) t->allocate(*this);
+}
+
 #endif
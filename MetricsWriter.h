@@ -0,0 +1,253 @@
+/**
+ * @file  MetricsWriter.h
+ * @brief Writes "/metrics" families in the Prometheus text, OpenMetrics text or Prometheus protobuf exposition formats
+ */
+
+#ifndef __METRICS_WRITER_H__
+#define __METRICS_WRITER_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <ResponseWriter.h>
+#include <Instrumentation.h>
+
+#define METRICS_CONTENT_TEXT        "text/plain; version=0.0.4; charset=utf-8"
+#define METRICS_CONTENT_OPENMETRICS "application/openmetrics-text; version=1.0.0; charset=utf-8"
+#define METRICS_CONTENT_PROTOBUF    "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited"
+#define METRICS_NAME_SIZE           96  // Longest metric family name, including the "_total" suffix of a counter
+#define METRICS_LABEL_SIZE          64  // Longest protobuf label name or value
+#define METRICS_MESSAGE_SIZE        512 // Largest protobuf Metric message, which is a histogram with its labels
+
+// Exposition formats, in the order of preference when a scraper accepts more than one
+enum MetricsFormat
+{
+  METRICS_FORMAT_TEXT,        // Prometheus text format 0.0.4
+  METRICS_FORMAT_OPENMETRICS, // OpenMetrics 1.0 text format
+  METRICS_FORMAT_PROTOBUF     // Length-delimited io.prometheus.client.MetricFamily messages
+};
+
+// Metric types, which are the protobuf MetricType values
+enum MetricsType
+{
+  METRICS_COUNTER   = 0,
+  METRICS_GAUGE     = 1,
+  METRICS_HISTOGRAM = 4
+};
+
+// Each family is started with begin() and followed by its samples. Every sample can have one label pair, and in labeled mode every sample also gets a
+// host="..." label. Counter families are named without the "_total" suffix, which is added where each format needs it. In the protobuf format, the
+// Metric messages of the current family are collected in a buffer, because each family is sent with its length in front of it. The text formats go
+// straight to the output, and values that aren't finite are written as NaN, +Inf or -Inf.
+class MetricsWriter
+{
+  private:
+    ResponseWriter& out;
+    MetricsFormat format;
+    const char* host;              // Value of the host label, or null for none
+    BufferWriter* family;          // Metric messages of the current protobuf family
+    char name[METRICS_NAME_SIZE];  // Name of the current family
+    char help[160];                // Help text of the current protobuf family
+    MetricsType type;              // Type of the current family
+    bool open = false;             // True while a family has been started and not finished
+    bool incomplete = false;       // True when a protobuf family was left out because its buffer couldn't grow
+
+    // Protobuf wire format helpers, which append to a byte array and return the new length
+    static int putVarint(uint8_t* p, int n, uint64_t v)
+    {
+      do
+      {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        p[n++] = v ? b | 0x80 : b;
+      } while (v);
+      return n;
+    }
+    static int putBytes(uint8_t* p, int n, int field, const void* data, size_t size)
+    {
+      n = putVarint(p, n, (field << 3) | 2);
+      n = putVarint(p, n, size);
+      memcpy(p + n, data, size);
+      return n + size;
+    }
+    static int putString(uint8_t* p, int n, int field, const char* s)
+    {
+      return putBytes(p, n, field, s, strlen(s));
+    }
+    static int putDouble(uint8_t* p, int n, int field, double v)
+    {
+      p[n++] = (field << 3) | 1;
+      memcpy(p + n, &v, sizeof(v)); // Little-endian, like the wire format
+      return n + sizeof(v);
+    }
+    static int putLabel(uint8_t* p, int n, const char* key, const char* value)
+    {
+      uint8_t pair[METRICS_LABEL_SIZE * 2 + 8];
+      size_t keySize = strnlen(key, METRICS_LABEL_SIZE), valueSize = strnlen(value, METRICS_LABEL_SIZE); // Longer labels are cut off
+      int size = putBytes(pair, 0, 1, key, keySize);
+      size = putBytes(pair, size, 2, value, valueSize);
+      return putBytes(p, n, 1, pair, size);
+    }
+
+    // Append the labels of a protobuf Metric message
+    int putLabels(uint8_t* p, int n, const char* labelName, const char* labelValue) const
+    {
+      if (host) n = putLabel(p, n, "host", host);
+      if (labelName) n = putLabel(p, n, labelName, labelValue);
+      return n;
+    }
+
+    // Add one Metric message to the current protobuf family
+    void addMessage(const uint8_t* message, int size)
+    {
+      uint8_t header[8];
+      int n = putVarint(header, 0, (4 << 3) | 2);
+      n = putVarint(header, n, size);
+      family->write((const char*)header, n);
+      family->write((const char*)message, size);
+    }
+
+    // Write a text value, using the OpenMetrics spelling of the special values
+    void printValue(const char* valueFormat, double value)
+    {
+      if (isnan(value)) out.print("NaN");
+      else if (isinf(value)) out.print(value > 0 ? "+Inf" : "-Inf");
+      else out.printf(valueFormat, value);
+    }
+
+    // Write the labels of a text sample, where "extra" is the histogram bucket bound
+    void printLabels(const char* labelName, const char* labelValue, const char* extra)
+    {
+      if (!host && !labelName && !extra) return;
+      const char* comma = "";
+      out.print("{");
+      if (host) { out.printf("host=\"%s\"", host); comma = ","; }
+      if (labelName) { out.printf("%s%s=\"%s\"", comma, labelName, labelValue); comma = ","; }
+      if (extra) out.printf("%sle=\"%s\"", comma, extra);
+      out.print("}");
+    }
+
+  public:
+    // Constructor. "buffer" holds the protobuf families while they are built, and is only needed for the protobuf format.
+    MetricsWriter(ResponseWriter& output, MetricsFormat metricsFormat, const char* hostLabel, BufferWriter* buffer)
+      : out(output), format(metricsFormat), host(hostLabel), family(buffer) {}
+
+    // Destructor, which finishes the last family
+    ~MetricsWriter() { finish(); }
+
+    // True when the host and stat labels are used, rather than a separate name for each statistic
+    bool labeled() const { return host != nullptr; }
+
+    // Start a family
+    void begin(const char* familyName, const char* description, MetricsType metricsType)
+    {
+      finish();
+      open = true;
+      type = metricsType;
+      const char* suffix = type == METRICS_COUNTER && format != METRICS_FORMAT_OPENMETRICS ? "_total" : ""; // OpenMetrics names counter families without it
+      snprintf(name, sizeof(name), "%s%s", familyName, suffix);
+      if (format == METRICS_FORMAT_PROTOBUF)
+      {
+        snprintf(help, sizeof(help), "%s", description);
+        family->clear();
+        return;
+      }
+      const char* typeName = type == METRICS_COUNTER ? "counter" : type == METRICS_HISTOGRAM ? "histogram" : "gauge";
+      out.printf("# HELP %s %s\n# TYPE %s %s\n", name, description, name, typeName);
+    }
+
+    // Add a gauge or counter sample with an optional label pair, using the printf() format for the text formats
+    void sample(const char* valueFormat, double value, const char* labelName = nullptr, const char* labelValue = nullptr)
+    {
+      if (format == METRICS_FORMAT_PROTOBUF)
+      {
+        uint8_t message[METRICS_LABEL_SIZE * 4 + 32], number[16]; // Two labels and a value
+        int n = putLabels(message, 0, labelName, labelValue);
+        int size = putDouble(number, 0, 1, value);
+        n = putBytes(message, n, type == METRICS_COUNTER ? 3 : 2, number, size);
+        addMessage(message, n);
+        return;
+      }
+      out.print(name);
+      if (type == METRICS_COUNTER && format == METRICS_FORMAT_OPENMETRICS) out.print("_total");
+      printLabels(labelName, labelValue, nullptr);
+      out.print(" ");
+      printValue(valueFormat, value);
+      out.print("\n");
+    }
+
+    // Add the samples of a latency histogram in seconds, with an optional label pair
+    void histogram(const LatencyHistogram& h, const char* labelName = nullptr, const char* labelValue = nullptr)
+    {
+      uint32_t counts[INSTRUMENTATION_BUCKETS + 1];
+      uint32_t total = h.cumulative(counts);
+      double sum = h.sumSeconds();
+      if (format == METRICS_FORMAT_PROTOBUF)
+      {
+        uint8_t message[METRICS_MESSAGE_SIZE], body[METRICS_MESSAGE_SIZE], bucket[24];
+        int size = putVarint(body, 0, 1 << 3);
+        size = putVarint(body, size, total);
+        size = putDouble(body, size, 2, sum);
+        for (int b = 0; b < INSTRUMENTATION_BUCKETS; b++) // The +Inf bucket is the sample count
+        {
+          int n = putVarint(bucket, 0, 1 << 3);
+          n = putVarint(bucket, n, counts[b]);
+          n = putDouble(bucket, n, 2, LatencyHistogram::bounds[b] / 1e6);
+          size = putBytes(body, size, 3, bucket, n);
+        }
+        int n = putLabels(message, 0, labelName, labelValue);
+        n = putBytes(message, n, 7, body, size);
+        addMessage(message, n);
+        return;
+      }
+      char bound[16];
+      for (int b = 0; b <= INSTRUMENTATION_BUCKETS; b++)
+      {
+        if (b < INSTRUMENTATION_BUCKETS) snprintf(bound, sizeof(bound), "%g", LatencyHistogram::bounds[b] / 1e6); else strcpy(bound, "+Inf");
+        out.printf("%s_bucket", name);
+        printLabels(labelName, labelValue, bound);
+        out.printf(" %u\n", (unsigned int)counts[b]);
+      }
+      out.printf("%s_sum", name);
+      printLabels(labelName, labelValue, nullptr);
+      out.printf(" %0.6f\n%s_count", sum, name);
+      printLabels(labelName, labelValue, nullptr);
+      out.printf(" %u\n", (unsigned int)total);
+    }
+
+    // Finish the current family, which sends a protobuf family with its length in front of it
+    void finish()
+    {
+      if (!open) return;
+      open = false;
+      if (format == METRICS_FORMAT_TEXT) out.print("\n");
+      if (format != METRICS_FORMAT_PROTOBUF) return;
+      family->flush();
+      if (family->overflowed())
+      {
+        incomplete = true; // Leave the family out, rather than sending a length that doesn't match its messages
+        return;
+      }
+      uint8_t header[METRICS_NAME_SIZE + sizeof(help) + 16], length[8];
+      int n = putString(header, 0, 1, name);
+      n = putString(header, n, 2, help);
+      n = putVarint(header, n, 3 << 3);
+      n = putVarint(header, n, type);
+      int prefix = putVarint(length, 0, n + family->size());
+      out.write((const char*)length, prefix);
+      out.write((const char*)header, n);
+      out.write(family->data(), family->size());
+    }
+
+    // True when a family was left out for lack of memory
+    bool failed() const { return incomplete; }
+
+    // End the exposition, which OpenMetrics marks with an EOF line
+    void end()
+    {
+      finish();
+      if (format == METRICS_FORMAT_OPENMETRICS) out.print("# EOF\n");
+    }
+};
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * @file  ResponseWriter.h
+ * @brief Helper classes to write formatted text to a web client or a memory buffer
+ */
+
+#ifndef __RESPONSE_WRITER_H__
+#define __RESPONSE_WRITER_H__
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESPONSE_WRITER_BLOCK_SIZE 1436 // Bytes per block, which matches a typical TCP segment payload
+
+// Interface for appending formatted text to a response. Subclasses decide where the text goes (a web client, a memory buffer, etc.).
+class ResponseWriter
+{
+  public:
+    virtual ~ResponseWriter() {}
+
+    // Append raw bytes
+    virtual void write(const char* data, size_t size) = 0;
+
+    // Append formatted text using vprintf() syntax. This default formats into a small stack buffer, or a temporary heap buffer for larger text.
+    virtual void vprintf(const char* format, va_list args)
+    {
+      char small[128];
+      va_list copy;
+      va_copy(copy, args);
+      int n = vsnprintf(small, sizeof(small), format, copy);
+      va_end(copy);
+      if (n < 0) return;
+      if ((size_t)n < sizeof(small))
+      {
+        write(small, n);
+        return;
+      }
+      char* temp = (char*)malloc(n + 1);
+      if (temp)
+      {
+        vsnprintf(temp, n + 1, format, args);
+        write(temp, n);
+        free(temp);
+      }
+    }
+
+    // Deliver any data held back by the writer
+    virtual void flush() {}
+
+    // Append a string
+    void print(const char* text)
+    {
+      write(text, strlen(text));
+    }
+
+    // Append formatted text using printf() syntax
+    void printf(const char* format, ...)
+    {
+      va_list args;
+      va_start(args, format);
+      vprintf(format, args);
+      va_end(args);
+    }
+};
+
+// Text appended to the writer is collected in the block buffer and handed to emit() each time the block fills up, so memory use stays
+// constant no matter how large the response is. Used for streaming, where each block becomes one network write.
+class BlockWriter : public ResponseWriter
+{
+  private:
+    char block[RESPONSE_WRITER_BLOCK_SIZE]; // Work area for the current block
+    size_t length = 0;                      // Number of bytes used in the current block
+
+  protected:
+    // Deliver one block of data
+    virtual void emit(const char* data, size_t size) = 0;
+
+  public:
+    void write(const char* data, size_t size) override
+    {
+      while (size)
+      {
+        size_t n = RESPONSE_WRITER_BLOCK_SIZE - length;
+        if (n > size) n = size;
+        memcpy(block + length, data, n);
+        length += n;
+        data += n;
+        size -= n;
+        if (length == RESPONSE_WRITER_BLOCK_SIZE) flush();
+      }
+    }
+
+    // Text is formatted straight into the block. Text larger than a whole block (such as an HTML template) is formatted in a temporary heap buffer.
+    void vprintf(const char* format, va_list args) override
+    {
+      va_list copy;
+      va_copy(copy, args);
+      size_t available = RESPONSE_WRITER_BLOCK_SIZE - length;
+      int n = vsnprintf(block + length, available, format, copy); // NOTE: vsnprintf() always NULL terminates, so the last byte of the block is never used by formatted text
+      va_end(copy);
+      if (n < 0) return;
+      if ((size_t)n < available)
+      {
+        length += n; // It fit
+        return;
+      }
+
+      // Didn't fit, so start a new block and try again
+      flush();
+      if ((size_t)n < RESPONSE_WRITER_BLOCK_SIZE)
+      {
+        length = vsnprintf(block, RESPONSE_WRITER_BLOCK_SIZE, format, args);
+      }
+      else
+      {
+        ResponseWriter::vprintf(format, args);
+      }
+    }
+
+    // Deliver the current partial block, if any
+    void flush() override
+    {
+      if (length)
+      {
+        emit(block, length);
+        length = 0;
+      }
+    }
+};
+
+// Collects everything written to it in a growable heap buffer, such as a cached response body that is rendered once and sent many times. When the
+// buffer can't grow, the data that doesn't fit is dropped and overflowed() is set until the next clear(), so incomplete data isn't sent as if it
+// were whole.
+class BufferWriter : public ResponseWriter
+{
+  private:
+    char* buffer = nullptr; // Collected data
+    size_t capacity = 0;    // Allocated size of the buffer
+    size_t used = 0;        // Number of bytes collected
+    bool overflow = false;  // True when some data was dropped since the last clear()
+
+  private:
+    // Make room for size more bytes, growing the buffer by doubling. Returns false, and records the overflow, when it can't grow.
+    bool reserve(size_t size)
+    {
+      if (used + size <= capacity) return true;
+      size_t n = capacity ? capacity : RESPONSE_WRITER_BLOCK_SIZE;
+      while (n < used + size) n *= 2;
+      char* p = (char*)realloc(buffer, n);
+      if (!p)
+      {
+        overflow = true; // Out of memory, so the data is dropped
+        return false;
+      }
+      buffer = p;
+      capacity = n;
+      return true;
+    }
+
+  public:
+    ~BufferWriter() { free(buffer); }
+
+    // Data is appended straight to the buffer, so there's no block to flush
+    void write(const char* data, size_t size) override
+    {
+      if (!reserve(size)) return;
+      memcpy(buffer + used, data, size);
+      used += size;
+    }
+
+    // Text is formatted straight into the spare capacity, after growing the buffer if it didn't fit
+    void vprintf(const char* format, va_list args) override
+    {
+      va_list copy;
+      va_copy(copy, args);
+      size_t available = capacity - used;
+      int n = vsnprintf(available ? buffer + used : nullptr, available, format, copy);
+      va_end(copy);
+      if (n < 0) return;
+      if ((size_t)n >= available)
+      {
+        if (!reserve(n + 1)) return; // Room for the NULL terminator written by vsnprintf()
+        vsnprintf(buffer + used, n + 1, format, args);
+      }
+      used += n;
+    }
+
+    // Discard the collected data, but keep the buffer for reuse
+    void clear()
+    {
+      used = 0;
+      overflow = false;
+    }
+
+    // True when data was dropped since the last clear() because the buffer couldn't grow
+    bool overflowed() const { return overflow; }
+
+    // Collected data
+    const char* data() const { return buffer; }
+    size_t size() const { return used; }
+};
+
+#endif
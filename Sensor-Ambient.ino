@@ -8,10 +8,13 @@
 #include <Wire.h>
 #include <WiFi.h>
 #include <WiFiClientSecure.h>     // MQTT TLS support
+#include <lwip/sockets.h>         // Non-blocking socket writes for the "/events" clients
 #include <PubSubClient.h>         // MQTT support from knolleary
 #include <ESPmDNS.h>              // mDNS support
 #include <WebServer.h>            // HTTP web server support
-#include <driver/i2s.h>           // I2S support for SPH0645 sound sensor
+#include <LittleFS.h>             // Flash file system for the data history log
+#include <driver/i2s_std.h>       // I2S support for SPH0645 sound sensor
+#include <esp_idf_version.h>      // ESP-IDF version checks
 #include <Adafruit_MAX1704X.h>    // LiPo battery support
 #include <Adafruit_VEML7700.h>    // VEML7700 ambient light sensor support
 #include <Adafruit_ST7789.h>      // TFT display support
@@ -20,59 +23,200 @@
 #include <SE_BME680.h>            // BME680 support
 #include <hal/efuse_hal.h>        // Espressif ESP32 chip information
 #include <time.h>                 // NTP and time support
+#include <esp_cpu.h>              // CPU cycle counter for benchmarks
+#include <algorithm>              // std::sort() for benchmarks
 
 // App configuration
 #include <MeasurementTracker.h>
+#include <Seqlock.h>
+#include <SoundLevelMeter.h>
+#include <DataHistory.h>
+#include <DataEncoding.h>
+#include <DataLog.h>
+#include <ResponseWriter.h>
+#include <Instrumentation.h>
+#include <MetricsWriter.h>
 #include <html.h>                 // HTML templates
+#include <html_assets.h>          // Compressed static web page assets
 #include <config.h>               // The configuration references objects in the above libraries, so include it after those
 
 // Data tracking
-#define I2C_INTERVAL 6000 // Millseconds between reading I2C devices, such as the light sensor, environmental sensor, and battery monitor. This value must accomodate the max time each sensor takes for a reading, such as the VEML7700 which can take over 5 seconds, to avoid impacting the BME680 IAQ calculation.
-#define MEASUREMENT_TRACKING_DATA_POINTS MEASUREMENT_WINDOW / (I2C_INTERVAL / 1000) // Number of data points to keep in MeasurementTracker() instances to achieve the desired measurement window
+#define I2C_INTERVAL_ENVIRONMENT 3000 // Milliseconds between BME680 readings, which is the sample rate for the IAQ algorithm
+#define I2C_INTERVAL_LIGHT       6000 // Milliseconds between VEML7700 readings
+#define I2C_INTERVAL_BATTERY     6000 // Milliseconds between MAX17048 readings
+#define I2C_SCHEDULER_TICK       25   // Milliseconds between I2C scheduler passes
+#define MEASUREMENT_TRACKING_DATA_POINTS(interval) (MEASUREMENT_WINDOW / ((interval) / 1000)) // Number of data points to keep in MeasurementTracker() instances to achieve the desired measurement window
+#define MEASUREMENT_FIXED(offset) (MEASUREMENT_PACKED ? 0.01F : 0), (offset) // Fixed point resolution and offset of a packed MeasurementTracker window
+MeasurementArena measurementArena; // Block shared by the MeasurementTracker windows, allocated by setupPsram(). Must be defined before the trackers.
+
+// Each device reading is split into a start step and a finish step. While a sensor is converting or integrating, the scheduler moves on to the other
+// devices, so a slow sensor (such as the VEML7700 in the dark) doesn't hold up the others, and each device can be read at its own interval. A single
+// task still does all of the I2C transactions, so no semaphore is needed for the bus.
+struct I2CDevice
+{
+  const char* name;         // Sensor name for the "/metrics" endpoint
+  unsigned long interval;   // Milliseconds between readings
+  bool powerSaveSlow;       // True if the device is read POWER_SAVE_I2C_FACTOR times less often in power save mode
+  unsigned long (*start)(); // Start a reading, and return the number of milliseconds until it can be finished, or NULL if there is nothing to start
+  bool (*finish)();         // Finish the reading, or return false to call start() again (such as after a range change, or while still converting)
+  bool busy;                // True between the start and finish steps
+  unsigned long started;    // millis() when the current reading was started
+  unsigned long due;        // millis() when the next step is due
+  LatencyHistogram latency; // Time spent in each finish step, which is where the sensor is read
+};
+#define I2C_DEVICES 3
+extern I2CDevice i2cDevices[I2C_DEVICES]; // Device table, defined with the scheduler task
 
 // ESP32
 char chipInformation[100];   // Chip information buffer
 
+// Instrumentation for the "/metrics" endpoint
+#define WEB_HANDLER_ROOT      0 // Timed web handlers
+#define WEB_HANDLER_DASHBOARD 1
+#define WEB_HANDLER_DATA      2
+#define WEB_HANDLER_METRICS   3
+#define WEB_HANDLER_ASSET     4
+#define WEB_HANDLERS          5
+const char* webHandlerNames[WEB_HANDLERS] = { "root", "dashboard", "data", "metrics", "asset" };
+LatencyHistogram webHandlerLatency[WEB_HANDLERS]; // Render time of each web handler
+#define WEB_EVENT_CLIENTS   3     // Max number of browsers connected to "/events" at once
+#define WEB_EVENT_INTERVAL  250   // Milliseconds between checks for new values to push to the "/events" clients
+#define WEB_EVENT_KEEPALIVE 15000 // Milliseconds between keepalive comments when there is nothing else to send, which also finds dropped clients
+#define WEB_EVENT_BACKLOG   8192  // Max bytes waiting to be sent to one "/events" client before it's dropped
+#define WEB_EVENT_STALL     10000 // Milliseconds an "/events" client can go without taking any bytes that are waiting for it before it's dropped
+LatencyHistogram mqttUpdateLatency;               // Time to build and publish each MQTT update
+LatencyHistogram mqttConnectLatency;              // Time to connect to the MQTT broker, including the TLS handshake
+LatencyHistogram mutexWaitUptime;                 // Time spent waiting for the uptime mutex
+LatencyHistogram mutexWaitDataSet;                // Time spent waiting for the data set mutex
+TaskLoad taskLoadLoop, taskLoadI2C, taskLoadSound, taskLoadWeb; // Busy time of each task
+RunTimeShare taskShareLoop, taskShareI2C, taskShareSound, taskShareWeb; // CPU use of each task between scrapes
+TaskHandle_t taskHandleLoop, taskHandleI2C, taskHandleSound, taskHandleWeb;
+
 // Web server
 WebServer webServer(80);
-char webStringBuffer[18 * 1024];
+#define METRICS_ENVIRONMENT 0 // Cached sections of the /metrics response, one per group of sensor values
+#define METRICS_SOUND       1
+#define METRICS_LIGHT       2
+#define METRICS_BATTERY     3
+#define METRICS_SECTIONS    4
+volatile bool metricsDirty[METRICS_SECTIONS] = { true, true, true, true }; // Set when new sensor values are published, so the section is rendered again
+BufferWriter metricsCache[METRICS_SECTIONS]; // Rendered metrics sections, only accessed by the web server task
+MetricsFormat metricsCacheFormat[METRICS_SECTIONS]; // Exposition format of each cached section
+BufferWriter metricsFamily; // Protobuf metric family being built, only accessed by the web server task
 
 // MQTT
 //WiFiClient espClient;     // For non-TLS connections
 WiFiClientSecure espClient; // Use WiFiClientSecure for TLS MQTT connections
 PubSubClient mqttClient(espClient);
 unsigned long mqttLastConnectionAttempt = 0;
+unsigned long mqttReconnectDelay = 0; // Milliseconds to wait before the next connection attempt, which backs off after each failure
+bool mqttWasConnected = false;        // True while the connection is up, to count drops
+volatile bool mqttConnected = false;  // Connection state kept by loop(), so the other tasks don't touch the MQTT client
+uint32_t mqttConnectAttempts = 0;     // Number of connection attempts since boot
+uint32_t mqttConnectFailures = 0;     // Number of failed connection attempts since boot
+uint32_t mqttDisconnects = 0;         // Number of established connections that were lost since boot
+BufferWriter mqttState; // JSON state document, built by updateMQTT() and published as a single message
+int mqttStateCount = 0; // Number of values in the JSON state document
+int mqttChangeCount = 0; // Number of values that changed since they were last published
+#define MQTT_DEADBAND_ANY  0, 0        // Deadband for values that are published on any change
+#define MQTT_DEADBAND_NONE INFINITY, 0 // Deadband for values that are only published on the heartbeat
+struct MqttReport
+{
+  float value;            // Last published value
+  bool published = false; // True once the value has been published
+};
 
 // TFT display
 Adafruit_ST7789 display = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
-GFXcanvas16 canvas(TFT_SCREEN_WIDTH, TFT_SCREEN_HEIGHT);
+#define TFT_LINES       5  // Number of text lines on the display
+#define TFT_LINE_HEIGHT 22 // Pixels per line, which is the FreeSans9pt7b line advance
+#define TFT_BASELINE    20 // Pixels from the top of a line to the text baseline
+GFXcanvas16 canvas(TFT_SCREEN_WIDTH, TFT_LINE_HEIGHT); // One line of the display, which is drawn off-screen and then sent to the display
+char displayLines[TFT_LINES][48]; // Text currently on the display, so only the lines that changed are drawn and sent again
+bool displayOn = true;    // True while the TFT backlight is on
 int64_t displayTimer = 0; // Timestamp of the last button press used to turn on the display
 
 // SPH0645 I2S sound sensor
-SemaphoreHandle_t xMutexSoundSensor; // Mutex to protect shared variables between tasks
-int32_t soundSensorDataBuffer[I2S_DMA_BUF_LEN]; // I2S read buffer
-MeasurementTracker soundSensorSpl = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS);
+i2s_chan_handle_t soundSensorChannel; // I2S receive channel
+QueueHandle_t soundSensorBuffers;     // Filled DMA buffers, queued by the I2S receive callback for the sound task
+volatile uint32_t soundSensorSequence = 0; // Number of DMA buffers filled since boot
+volatile uint32_t soundSensorOverruns = 0; // Number of filled DMA buffers that were overwritten before the sound task measured them
+struct SoundBuffer
+{
+  const int32_t* frames; // DMA buffer owned by the I2S driver
+  size_t size;           // Number of bytes in the buffer
+  uint32_t sequence;     // Value of soundSensorSequence when the buffer was filled
+};
+SoundLevelMeter soundLevelMeter(SPL_CALIBRATION_OFFSET, SOUND_LEQ_WINDOW);
+MeasurementTracker soundSensorSpl = MeasurementTracker(MEASUREMENT_WINDOW, measurementArena, MEASUREMENT_FIXED(0), MEASUREMENT_OPERATORS_SOUND); // Tracks the 1-second A-weighted level, once per second
+#if I2S_SAMPLE_RATE != SOUND_LEVEL_SAMPLE_RATE
+  #error "I2S_SAMPLE_RATE must match the SoundLevelMeter A-weighting filter design"
+#endif
+struct SoundSnapshot
+{
+  MeasurementStats spl; // 1-second A-weighted levels
+  float leq, lmax, l90; // Statistics over the last SOUND_LEQ_WINDOW seconds
+};
+Seqlock<SoundSnapshot> soundSnapshot; // Sound values published by the sound task for all other tasks
 
 // VML7700 light sensor
 Adafruit_VEML7700 lightSensor = Adafruit_VEML7700();
-SemaphoreHandle_t xMutexLightSensor; // Mutex to protect shared variables between tasks
-MeasurementTracker lightSensorLux = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS);
-float lightSensorGain = VEML7700_GAIN_1; // Current gain setting for the light sensor, read/updated from the AGC
-int lightSensorIntegrationTime = VEML7700_IT_100MS; // Current integration time setting for the light sensor, read/updated from the AGC
+MeasurementTracker lightSensorLux = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_LIGHT), measurementArena, 0, 0, MEASUREMENT_OPERATORS_LIGHT); // Float, since lux values go past the fixed point range
+float lightSensorGain = 1; // Current gain factor for the light sensor, updated by the auto-range steps
+int lightSensorIntegrationTime = 100; // Current integration time for the light sensor in milliseconds, updated by the auto-range steps
+#define VEML7700_ALS_LOW  100   // Raw ALS counts below this are too coarse at the current range, so the sensor steps to a more sensitive range
+#define VEML7700_ALS_HIGH 10000 // Raw ALS counts above this are close to saturation at the current range, so the sensor steps to a less sensitive range
+#define VEML7700_MAX_RESOLUTION 0.0036F // Lux per count at gain 2 and 800ms, which is the most sensitive range
+struct LightSensorRange
+{
+  uint8_t gain, integrationTime; // VEML7700 settings
+  float gainFactor;              // Gain as a multiplier
+  int integrationMillis;         // Integration time in milliseconds
+};
+const LightSensorRange lightSensorRanges[] = { // Auto-range ladder from least to most sensitive, in the same order as the Adafruit auto-gain search
+  { VEML7700_GAIN_1_8, VEML7700_IT_25MS,  0.125, 25  },
+  { VEML7700_GAIN_1_8, VEML7700_IT_50MS,  0.125, 50  },
+  { VEML7700_GAIN_1_8, VEML7700_IT_100MS, 0.125, 100 },
+  { VEML7700_GAIN_1_4, VEML7700_IT_100MS, 0.25,  100 },
+  { VEML7700_GAIN_1,   VEML7700_IT_100MS, 1,     100 },
+  { VEML7700_GAIN_2,   VEML7700_IT_100MS, 2,     100 },
+  { VEML7700_GAIN_2,   VEML7700_IT_200MS, 2,     200 },
+  { VEML7700_GAIN_2,   VEML7700_IT_400MS, 2,     400 },
+  { VEML7700_GAIN_2,   VEML7700_IT_800MS, 2,     800 }
+};
+#define VEML7700_RANGES (int)(sizeof(lightSensorRanges) / sizeof(lightSensorRanges[0]))
+int lightSensorRange = 4; // Current index in the auto-range ladder, which is kept between readings
+struct LightSnapshot
+{
+  MeasurementStats lux;
+  float gain;
+  int integrationTime;
+};
+Seqlock<LightSnapshot> lightSnapshot; // Light values published by the I2C task for all other tasks
 
 // BME680
 SE_BME680 bme680;
-SemaphoreHandle_t xMutexEnvironmental;     // Mutex to protect shared variables between tasks
 bool environmentSensorOK = false;          // True if the sensor is operational
-MeasurementTracker environmentTemperature = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS);
-MeasurementTracker environmentDewPoint    = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS);
-MeasurementTracker environmentHumidity    = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS);
-MeasurementTracker environmentPressure    = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS);
-MeasurementTracker environmentIAQ         = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS); // 0-100% representing "bad" to "good"
+unsigned long environmentReadingEnd = 0;   // millis() when the conversion in progress is done, or 0 if none
+MeasurementTracker environmentTemperature = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT), measurementArena, MEASUREMENT_FIXED(0), MEASUREMENT_OPERATORS_ENVIRONMENT);
+MeasurementTracker environmentDewPoint    = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT), measurementArena, MEASUREMENT_FIXED(0), MEASUREMENT_OPERATORS_ENVIRONMENT);
+MeasurementTracker environmentHumidity    = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT), measurementArena, MEASUREMENT_FIXED(0), MEASUREMENT_OPERATORS_ENVIRONMENT);
+MeasurementTracker environmentPressure    = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT), measurementArena, MEASUREMENT_FIXED(1000), MEASUREMENT_OPERATORS_ENVIRONMENT); // Offset so 673-1327 mbar fits
+MeasurementTracker environmentIAQ         = MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT), measurementArena, MEASUREMENT_FIXED(0), MEASUREMENT_OPERATORS_ENVIRONMENT); // 0-100% representing "bad" to "good"
 int      environmentIAQAccuracy;           // 0 = unreliable, 1 = low, 2 = medium, 3 = high, 4 = very high
 uint32_t environmentGasResistance;         // MOX gas resistance
 float    environmentGasAccuracy;           // Accuracy of gas calibration as a percentage
 int      environmentGasCalibrationStage;
+struct EnvironmentSnapshot
+{
+  bool ok;
+  MeasurementStats temperature, dewPoint, humidity, pressure, iaq;
+  int iaqAccuracy;
+  uint32_t gasResistance;
+  float gasAccuracy;
+  int gasCalibrationStage;
+};
+Seqlock<EnvironmentSnapshot> environmentSnapshot; // Environmental values published by the I2C task for all other tasks
 
 // Uptime calculations
 SemaphoreHandle_t xMutexUptime; // Mutex to protect shared variables between tasks
@@ -81,22 +225,134 @@ int64_t lastUptimeSecondsTotal = 0;
 char uptimeStringBuffer[24]; // Used by multiple threads
 
 // LiPo battery and AC power state
-SemaphoreHandle_t xMutexBattery; // Mutex to protect shared variables between tasks
 Adafruit_MAX17048 max17048;
 float batteryVoltage;
 float batteryPercent;
+ExponentialAverage batteryVoltageAverage(MEASUREMENT_WINDOW); // Smooths the battery readings
+ExponentialAverage batteryPercentAverage(MEASUREMENT_WINDOW);
 int acPowerState; // Is set to 1 when 5V is present on the USB bus (AC power is on), and 0 when not (AC power is off)
+float batteryChargeRate; // Percent per hour, negative while discharging
+struct BatterySnapshot
+{
+  float voltage;
+  float percent;
+  int acPowerState;
+  float chargeRate;
+  bool powerSaveRequested; // True while power save mode should be used, which loop() applies
+};
+
+// Power save mode, used while running on the battery
+volatile bool powerSaveMode = false; // True while in power save mode, set by loop() and read by the others
+uint32_t cpuFrequencyFull;           // CPU frequency in MHz for full power mode, which is the frequency at boot
+Seqlock<BatterySnapshot> batterySnapshot; // Battery values published by the I2C task for all other tasks
 
 // PSRAM historical data streams for the web page charts
-#define DATA_ELEMENT_SIZE   10    // Size of one data value as numeric text, with comma delimiter
-#define DATA_STREAM_COUNT   10    // There are ten data streams: sound, light, temperature, humidity, dew point, pressure, IAQ, gas resistance, gas accuracy, time
-#define DATA_STREAM_SIZE    DATA_HISTORY_COUNT * DATA_ELEMENT_SIZE // Size of a single data stream in bytes
-#define DATA_SET_SIZE       DATA_STREAM_SIZE * DATA_STREAM_COUNT   // Size of the entire data set in bytes
-unsigned char* psramDataSet;
+SemaphoreHandle_t xMutexDataSet; // Mutex to protect the data tiers between the main loop and the web server task
+
+// Data stream registry, with one X(id, name, value, resolution, factor, tracker) entry per charted value stream, in stream order:
+//    id          Suffix of the DATA_STREAM_<id> index
+//    name        Stream name for the web page charts and the MQTT history batches, which matches the MQTT state document key
+//    value       Current value, evaluated by readDataSample() with the environment/sound/light snapshots in scope. NAN for a missing value.
+//    resolution  Resolution of the stream in the binary /data format
+//    factor      Multiplier from the stored value to the MQTT value, such as kiloohms (for the chart scale) to ohms
+//    tracker     MeasurementTracker to seed from the flash log at boot, or nullptr
+// Everything that depends on the streams is generated from this table: the PSRAM tier and flash log layouts, the /data stream numbers and scales,
+// the chart stream names, the MQTT history keys and the tracker restore. The time index is always the last stream.
+#define DATA_STREAMS(X) \
+  X(TEMPERATURE,    "environmental_temperature",              environment.temperature.current,                  0.01F, 1.0F,    &environmentTemperature) \
+  X(HUMIDITY,       "environmental_humidity",                 environment.humidity.current,                     0.01F, 1.0F,    &environmentHumidity) \
+  X(DEW_POINT,      "environmental_dew_point",                environment.dewPoint.current,                     0.01F, 1.0F,    &environmentDewPoint) \
+  X(PRESSURE,       "environmental_pressure_mbar",            environment.pressure.current,                     0.01F, 1.0F,    &environmentPressure) \
+  X(IAQ,            "environmental_iaq",                      iaqReady ? environment.iaq.current : NAN,         0.01F, 1.0F,    &environmentIAQ) \
+  X(GAS_RESISTANCE, "environmental_gas_resistance_ohms",      iaqReady ? environment.gasResistance / 1000.0F : NAN, 0.01F, 1000.0F, nullptr) \
+  X(GAS_ACCURACY,   "environmental_gas_calibration_accuracy", iaqReady ? environment.gasAccuracy : NAN,         0.01F, 1.0F,    nullptr) \
+  X(SOUND,          "sound_level_leq_db",                     sound.leq,                                        0.01F, 1.0F,    &soundSensorSpl) \
+  X(LIGHT,          "light_level_lux",                        light.lux.current,                                0.01F, 1.0F,    &lightSensorLux)
+#define DATA_STREAM_INDEX(id, name, value, resolution, factor, tracker)  DATA_STREAM_##id,
+#define DATA_STREAM_NAME(id, name, value, resolution, factor, tracker)   name,
+#define DATA_STREAM_JSON(id, name, value, resolution, factor, tracker)   "\"" name "\","
+#define DATA_STREAM_SCALE(id, name, value, resolution, factor, tracker)  resolution,
+#define DATA_STREAM_FACTOR(id, name, value, resolution, factor, tracker) factor,
+enum DataStream
+{
+  DATA_STREAMS(DATA_STREAM_INDEX)
+  DATA_STREAM_TIME,  // Time index
+  DATA_STREAM_COUNT  // Number of streams, including the time index
+};
+#define DATA_VALUE_STREAMS DATA_STREAM_TIME // Every stream except the time index is stored as a float value
+const char dataStreamNames[] = "[" DATA_STREAMS(DATA_STREAM_JSON) "\"time\"]"; // Stream names as a JavaScript array, for the web page
+
+// Published value registries, which list the sensor values sent as Prometheus metrics by "/metrics" and as MQTT topics by updateMQTT(). Each list is
+// expanded with a STATS(name, description, format, measurement, deadband) macro for current/min/average/max values from a MeasurementStats snapshot,
+// which adds the "_min", "_average" and "_max" name suffixes (and the summary suffixes, such as "_p95", for the tracker's operators), and a VALUE(name, description, format, value, deadband) macro for single values. The
+// name is both the metric name and the topic after MQTT_TOPIC_BASE. Entries read the environment/sound/light/battery snapshots in scope.
+#ifdef BME680_TEMP_F
+  #define SCRAPE_UNITS "(F)"
+#else
+  #define SCRAPE_UNITS "(C)"
+#endif
+#define PUBLISH_ENVIRONMENT(STATS, VALUE) \
+  STATS("environmental_temperature",   "Environment temperature " SCRAPE_UNITS,          "%0.1f", environment.temperature, MQTT_DEADBAND_TEMPERATURE) \
+  STATS("environmental_dew_point",     "Environment calculated dew point " SCRAPE_UNITS, "%0.1f", environment.dewPoint,    MQTT_DEADBAND_TEMPERATURE) \
+  STATS("environmental_humidity",      "Environment humidity (RH%)",                     "%0.1f", environment.humidity,    MQTT_DEADBAND_HUMIDITY) \
+  STATS("environmental_pressure_mbar", "Environment barometric pressure",                "%0.1f", environment.pressure,    MQTT_DEADBAND_PRESSURE)
+#define PUBLISH_IAQ(STATS, VALUE) \
+  STATS("environmental_iaq", "Environment IAQ (0-100%, 0%=bad, 100%=good)", "%0.2f", environment.iaq, MQTT_DEADBAND_IAQ)
+#define PUBLISH_GAS(STATS, VALUE) \
+  VALUE("environmental_iaq_accuracy",             "Environment IAQ accuracy (0=unreliable, 1=low, 2=medium, 3=high, 4=very high)", "%0.0f", environment.iaqAccuracy,   MQTT_DEADBAND_ANY) \
+  VALUE("environmental_gas_resistance_ohms",      "Environment gas resistance",                                                    "%0.0f", environment.gasResistance, MQTT_DEADBAND_GAS_RESISTANCE) \
+  VALUE("environmental_gas_calibration_accuracy", "Environment gas calibration accuracy (0-100%, 0%=bad, 100%=good)",              "%0.1f", environment.gasAccuracy,   MQTT_DEADBAND_IAQ)
+#define PUBLISH_SOUND(STATS, VALUE) \
+  STATS("sound_level_db",      "Sound pressure level",                                  "%0.2f", sound.spl,  MQTT_DEADBAND_SOUND) \
+  VALUE("sound_level_leq_db",  "Sound equivalent continuous level over the Leq window", "%0.2f", sound.leq,  MQTT_DEADBAND_SOUND) \
+  VALUE("sound_level_lmax_db", "Sound max 125ms level over the Leq window",             "%0.2f", sound.lmax, MQTT_DEADBAND_SOUND) \
+  VALUE("sound_level_l90_db",  "Sound level exceeded 90% of the Leq window",            "%0.2f", sound.l90,  MQTT_DEADBAND_SOUND)
+#define PUBLISH_LIGHT(STATS, VALUE) \
+  STATS("light_level_lux",                             "Light level",                        "%0.2f", light.lux,             MQTT_DEADBAND_LIGHT) \
+  VALUE("light_level_measurement_gain",                "Light measurement gain",             "%0.3f", light.gain,            MQTT_DEADBAND_ANY) \
+  VALUE("light_level_measurement_integration_time_ms", "Light measurement integration time", "%0.0f", light.integrationTime, MQTT_DEADBAND_ANY)
+#define PUBLISH_BATTERY(STATS, VALUE) \
+  VALUE("esp32_battery_voltage", "ESP32 LiPo battery voltage", "%0.2f", battery.voltage,      MQTT_DEADBAND_BATTERY_VOLTAGE) \
+  VALUE("esp32_battery_percent", "ESP32 LiPo battery percent", "%0.2f", battery.percent,      MQTT_DEADBAND_BATTERY_PERCENT) \
+  VALUE("esp32_ac_power_state",  "ESP32 AC power state",       "%0.0f", battery.acPowerState, MQTT_DEADBAND_ANY)
+DataHistory psramDataSet; // Binary ring buffer of all data streams, stored in PSRAM
+DataHistory psramDataSet15m;   // 15-minute rollup tier with min/average/max per value stream
+DataHistory psramDataSetDaily; // Daily rollup tier with min/average/max per value stream
+DataRollup dataRollup15m(DATA_VALUE_STREAMS, 15 * 60);
+DataRollup dataRollupDaily(DATA_VALUE_STREAMS, 24 * 60 * 60);
+const float dataStreamScale[DATA_STREAM_COUNT] = { DATA_STREAMS(DATA_STREAM_SCALE) 1.0F }; // Resolution of each stream in the binary /data format
+#define DATA_COPY_BATCH    64              // Number of elements copied out of a data tier each time the data set mutex is taken
+
+// Flash log of the data set, so the history can be restored after a reboot
+DataLog dataLog(DATA_VALUE_STREAMS, DATA_HISTORY_COUNT, DATA_LOG_BATCH);
+bool dataLogReady = false;       // True once the log has been opened
+int64_t dataLogBootEpoch = 0;    // Clock time at boot, which converts log times to time indexes in seconds of uptime
+#define DATA_LOG_VALID_EPOCH 1700000000 // Clock times before this mean NTP hasn't set the clock yet
+#define DATA_LOG_SYNC_TIMEOUT 10000     // Milliseconds to wait for NTP at boot before giving up on restoring the history
+
+// MQTT offline queue
+DataHistory mqttQueue;                // PSRAM queue of samples taken while the broker can't be reached, sent as batches after reconnecting
+uint32_t mqttQueueNext = 0;           // Sequence number of the oldest queued sample that hasn't been sent
+uint32_t mqttQueuePending = 0;        // Number of queued samples that haven't been sent, for the metrics
+uint32_t mqttQueueDropped = 0;        // Number of queued samples that were overwritten before they could be sent
+unsigned long mqttQueueLastBatch = 0; // Time the last batch was sent
+BufferWriter mqttQueueBatch;          // JSON document for one batch of queued samples
+#define MQTT_QUEUE_STREAMS (DATA_VALUE_STREAMS + 3) // The data set streams, then battery voltage, battery percent and AC power state
+const char* mqttQueueNames[MQTT_QUEUE_STREAMS] = { DATA_STREAMS(DATA_STREAM_NAME) "esp32_battery_voltage", "esp32_battery_percent", "esp32_ac_power_state" }; // JSON keys, which match the state document
+const float mqttQueueFactors[MQTT_QUEUE_STREAMS] = { DATA_STREAMS(DATA_STREAM_FACTOR) 1.0F, 1.0F, 1.0F }; // Multipliers from the queued values to the published values
+
+// Take a mutex, and record how long it took
+inline void takeMutex(SemaphoreHandle_t mutex, LatencyHistogram& wait)
+{
+  int64_t start = INSTRUMENTATION_MICROS();
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  wait.record(INSTRUMENTATION_MICROS() - start);
+}
 
 // Main loop
 uint64_t timer = 0; // Copy of the main uptime timer that doesn't need a semaphore
 uint64_t lastUpdateTimeMqtt = 0; // Time of last MQTT update
+uint64_t lastCheckTimeMqtt  = 0; // Time of last MQTT report-on-change check
 uint64_t lastUpdateTimeTft  = 0; // Time of last OLED update
 uint64_t lastUpdateTimeData = 0; // Time of last data set update
 
@@ -153,19 +409,30 @@ void setupMDNS()
 // Web Server
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Web helper function for using sprintf() to append to the web string buffer
-inline int bytesAdded(int sprintfReturnValue)
+// Streams a web response to the current client using chunked transfer encoding, one small block at a time
+class WebResponseWriter : public BlockWriter
 {
-  // Ignore negative/error sprintf() return values so they don't affect pointer arithmetic in the calling function
-  return sprintfReturnValue > 0 ? sprintfReturnValue : 0;
-}
+  protected:
+    void emit(const char* data, size_t size) override
+    {
+      webServer.sendContent(data, size);
+    }
 
-// Web helper function to append a string to the web string buffer
-inline int buffercat(char* dest, const char* source)
-{
-  strcpy(dest, source);
-  return strlen(source);
-}
+  public:
+    // Send the response headers. The content follows in chunks as it's written.
+    WebResponseWriter(int code, const char* contentType)
+    {
+      webServer.setContentLength(CONTENT_LENGTH_UNKNOWN); // Chunked transfer encoding
+      webServer.send(code, contentType, "");
+    }
+
+    // Send any remaining content and the final (empty) chunk
+    void end()
+    {
+      flush();
+      webServer.sendContent("");
+    }
+};
 
 // Web helper function to describe IAQ accuracy values
 char* webFormatIAQAccuracy(int a)
@@ -180,87 +447,81 @@ char* webFormatIAQAccuracy(int a)
   return "Unreliable";
 }
 
-// Web helper function to output current/min/average/max values from a MeasurementTracker instance
-char* webRenderMeasurementValues(char* buffer, char* description, char* format, MeasurementTracker& measurement)
+// Web helper function to output current/min/average/max values from a MeasurementTracker snapshot
+void webRenderMeasurementValues(ResponseWriter& out, char* description, char* format, const MeasurementStats& measurement)
 {
-  buffer += buffercat(buffer, description); // Start of table row
-  buffer += bytesAdded(sprintf(buffer, format, measurement.min));
-  buffer += bytesAdded(sprintf(buffer, format, measurement.max));
-  buffer += bytesAdded(sprintf(buffer, format, measurement.average));
-  buffer += bytesAdded(sprintf(buffer, format, measurement.current));
-  buffer += buffercat(buffer, "</tr>"); // Close the table row 
-  return buffer;
+  out.print(description); // Start of table row
+  out.printf(format, measurement.min);
+  out.printf(format, measurement.max);
+  out.printf(format, measurement.average);
+  out.printf(format, measurement.current);
+  out.print("</tr>"); // Close the table row 
 }
 
-// Web helper function to render the main data table (the "dashboard") at the specified buffer position
-char* webRenderDashboard(char* buffer)
+// Web helper function to render the main data table (the "dashboard") to the specified writer
+void webRenderDashboard(ResponseWriter& out)
 {
   IPAddress ip = WiFi.localIP();
   struct tm timeInfo; // NTP
 
-  buffer += buffercat(buffer, "<table id=\"dashboard\" class=\"sensor\" cellspacing=\"0\" cellpadding=\"3\">"); // Sensor data table
-  buffer += bytesAdded(sprintf(buffer, "<tr><th colspan=\"5\" class=\"header\">%s</th></tr>", WIFI_HOSTNAME)); // Network hostname
-  buffer += buffercat(buffer, "<tr class=\"subheader\"><th></th><td>Min</td><td>Max</td><td>Average</td><td>Current</td></tr>");
+  out.print("<table id=\"dashboard\" class=\"sensor\" cellspacing=\"0\" cellpadding=\"3\">"); // Sensor data table
+  out.printf("<tr><th colspan=\"5\" class=\"header\">%s</th></tr>", WIFI_HOSTNAME); // Network hostname
+  out.print("<tr class=\"subheader\"><th></th><td>Min</td><td>Max</td><td>Average</td><td>Current</td></tr>");
 
-  xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data (calculated on a different thread)
-  if (environmentSensorOK)
+  EnvironmentSnapshot environment = environmentSnapshot.read(); // Consistent copy of the environmental data (published by a different thread)
+  if (environment.ok)
   {
     #ifdef BME680_TEMP_F
       #define WEB_UNITS "F"
     #else
       #define WEB_UNITS "C"
     #endif
-    buffer = webRenderMeasurementValues(buffer, "<tr class=\"environmental\"><th>Environment Temperature</th>",         "<td>%0.1f&deg; " WEB_UNITS "</td>", environmentTemperature);
-    buffer = webRenderMeasurementValues(buffer, "<tr class=\"environmental\"><th>Environment Dew Point</th>",           "<td>%0.1f&deg; " WEB_UNITS "</td>", environmentDewPoint);
-    buffer = webRenderMeasurementValues(buffer, "<tr class=\"environmental\"><th>Environment Humidity</th>",            "<td>%0.1f%%</td>",                  environmentHumidity);
-    buffer = webRenderMeasurementValues(buffer, "<tr class=\"environmental\"><th>Environment Barometric Pressure</th>", "<td>%0.1f mbar</td>",               environmentPressure);
-    if (environmentIAQAccuracy)
+    webRenderMeasurementValues(out, "<tr class=\"environmental\" id=\"temperature\"><th>Environment Temperature</th>",         "<td>%0.1f&deg; " WEB_UNITS "</td>", environment.temperature);
+    webRenderMeasurementValues(out, "<tr class=\"environmental\" id=\"dewpoint\"><th>Environment Dew Point</th>",           "<td>%0.1f&deg; " WEB_UNITS "</td>", environment.dewPoint);
+    webRenderMeasurementValues(out, "<tr class=\"environmental\" id=\"humidity\"><th>Environment Humidity</th>",            "<td>%0.1f%%</td>",                  environment.humidity);
+    webRenderMeasurementValues(out, "<tr class=\"environmental\" id=\"pressure\"><th>Environment Barometric Pressure</th>", "<td>%0.1f mbar</td>",               environment.pressure);
+    if (environment.iaqAccuracy)
     {
-      buffer = webRenderMeasurementValues(buffer, "<tr class=\"environmental\"><th>Environment IAQ</th>", "<td>%0.2f%%</td>", environmentIAQ);
+      webRenderMeasurementValues(out, "<tr class=\"environmental\" id=\"iaq\"><th>Environment IAQ</th>", "<td>%0.2f%%</td>", environment.iaq);
     }  
-    buffer += bytesAdded(sprintf(buffer, "<tr class=\"environmental\"><th>Environment IAQ Accuracy</th><td colspan=\"4\">%d (%s)</td></tr>",             environmentIAQAccuracy, webFormatIAQAccuracy(environmentIAQAccuracy)));
-    buffer += bytesAdded(sprintf(buffer, "<tr class=\"environmental\"><th>Environment Gas Resistance</th><td colspan=\"4\">%d ohms</td></tr>",           environmentGasResistance));
-    buffer += bytesAdded(sprintf(buffer, "<tr class=\"environmental\"><th>Environment Gas Calibration Accuracy</th><td colspan=\"4\">%0.1f%%</td></tr>", environmentGasAccuracy));
+    out.printf("<tr class=\"environmental\"><th>Environment IAQ Accuracy</th><td colspan=\"4\">%d (%s)</td></tr>",             environment.iaqAccuracy, webFormatIAQAccuracy(environment.iaqAccuracy));
+    out.printf("<tr class=\"environmental\" id=\"gas\"><th>Environment Gas Resistance</th><td colspan=\"4\">%d ohms</td></tr>",           environment.gasResistance);
+    out.printf("<tr class=\"environmental\" id=\"gasaccuracy\"><th>Environment Gas Calibration Accuracy</th><td colspan=\"4\">%0.1f%%</td></tr>", environment.gasAccuracy);
   }
   else
   {
-    buffer += buffercat(buffer, "<tr class=\"environmental\"><th>Environment Sensor Stabilized?</th><td colspan=\"4\">0 (No)</td></tr>");
+    out.print("<tr class=\"environmental\"><th>Environment Sensor Stabilized?</th><td colspan=\"4\">0 (No)</td></tr>");
   }
-  xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
 
-  xSemaphoreTake(xMutexSoundSensor, portMAX_DELAY); // Start accessing sound data (measured on a different thread)
-  buffer = webRenderMeasurementValues(buffer, "<tr class=\"soundlight\"><th>Sound Level</th>", "<td>%0.2f dB</td>", soundSensorSpl);
-  xSemaphoreGive(xMutexSoundSensor); // Done with sound data
+  SoundSnapshot sound = soundSnapshot.read(); // Consistent copy of the sound data (published by a different thread)
+  webRenderMeasurementValues(out, "<tr class=\"soundlight\" id=\"sound\"><th>Sound Level</th>", "<td>%0.2f dBA</td>", sound.spl);
+  out.printf("<tr class=\"soundlight\" id=\"leq\"><th>Sound Leq / Lmax / L90 (%d seconds)</th><td colspan=\"4\">%0.1f / %0.1f / %0.1f dBA</td></tr>", SOUND_LEQ_WINDOW, sound.leq, sound.lmax, sound.l90);
 
-  xSemaphoreTake(xMutexLightSensor, portMAX_DELAY); // Start accessing light data (measured on a different thread)
-  buffer = webRenderMeasurementValues(buffer, "<tr class=\"soundlight\"><th>Light Level</th>", "<td>%0.2f lux</td>", lightSensorLux);
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"soundlight\"><th>Light Measurement Gain</th><td colspan=\"4\">%0.3f</td></tr>", lightSensorGain));
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"soundlight\"><th>Light Measurement Integration Time</th><td colspan=\"4\">%d ms</td></tr>", lightSensorIntegrationTime));
-  xSemaphoreGive(xMutexLightSensor); // Done with light data
+  LightSnapshot light = lightSnapshot.read(); // Consistent copy of the light data (published by a different thread)
+  webRenderMeasurementValues(out, "<tr class=\"soundlight\" id=\"light\"><th>Light Level</th>", "<td>%0.2f lux</td>", light.lux);
+  out.printf("<tr class=\"soundlight\" id=\"lightgain\"><th>Light Measurement Gain</th><td colspan=\"4\">%0.3f</td></tr>", light.gain);
+  out.printf("<tr class=\"soundlight\" id=\"lightintegration\"><th>Light Measurement Integration Time</th><td colspan=\"4\">%d ms</td></tr>", light.integrationTime);
 
-  xSemaphoreTake(xMutexUptime, portMAX_DELAY); // Start accessing the uptime data (calculated on a different thread)
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"system\"><th>Measurement Window for Min/Average/Max</th><td colspan=\"4\">%d seconds</td></tr>", MEASUREMENT_WINDOW));
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"system\"><th>Uptime</th><td colspan=\"2\">%lld seconds</td><td colspan=\"2\">%s</td></tr>", uptimeSecondsTotal, uptimeStringBuffer));
+  takeMutex(xMutexUptime, mutexWaitUptime); // Start accessing the uptime data (calculated on a different thread)
+  out.printf("<tr class=\"system\"><th>Measurement Window for Min/Average/Max</th><td colspan=\"4\">%d seconds</td></tr>", MEASUREMENT_WINDOW);
+  out.printf("<tr class=\"system\"><th>Uptime</th><td colspan=\"2\">%lld seconds</td><td colspan=\"2\">%s</td></tr>", uptimeSecondsTotal, uptimeStringBuffer);
   if (getLocalTime(&timeInfo))
   {
-    buffer += bytesAdded(sprintf(buffer, "<tr class=\"system\"><th>System Time</th><td colspan=\"4\">%02d/%02d/%02d %02d:%02d:%02d</td></tr>", timeInfo.tm_mon + 1, timeInfo.tm_mday, timeInfo.tm_year + 1900, timeInfo.tm_hour, timeInfo.tm_min, timeInfo.tm_sec));
+    out.printf("<tr class=\"system\"><th>System Time</th><td colspan=\"4\">%02d/%02d/%02d %02d:%02d:%02d</td></tr>", timeInfo.tm_mon + 1, timeInfo.tm_mday, timeInfo.tm_year + 1900, timeInfo.tm_hour, timeInfo.tm_min, timeInfo.tm_sec);
   }
   xSemaphoreGive(xMutexUptime); // Done with uptime data
 
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"network\"><th>MQTT Server</th><td colspan=\"4\">%s mqtts://%s:%d</td></tr>", mqttClient.connected() ? "Connected to" : "Disconnected from ", MQTT_SERVER, MQTT_PORT));
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"network\"><th>IP Address</th><td colspan=\"4\">%d.%d.%d.%d</td></tr>", ip[0], ip[1], ip[2], ip[3]));
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"network\"><th>WiFi Signal Strength (%s)</th><td colspan=\"4\">%d dBm</td></tr>", WIFI_SSID, WiFi.RSSI()));
-
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"chip\"><th>Free Heap Memory</th><td colspan=\"4\">%d bytes</td></tr>", ESP.getFreeHeap())); // ESP32 free heap memory, which indicates if the program still has enough memory to run effectively
-  xSemaphoreTake(xMutexBattery, portMAX_DELAY); // Start accessing the battery data (calculated on a different thread)
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"chip\"><th>Battery</th><td colspan=\"4\">%0.2fV / %0.0f%%</td></tr>", batteryVoltage, batteryPercent)); // LiPo battery
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"chip\"><th>AC Power State</th><td colspan=\"4\">%s</td></tr>", acPowerState ? "1 (On)" : "0 (Off)")); // AC power sense
-  xSemaphoreGive(xMutexBattery); // Done with battery data
-  buffer += bytesAdded(sprintf(buffer, "<tr class=\"chip\"><th>Chip Information</th><td colspan=\"4\">%s</td></tr>", chipInformation));
+  out.printf("<tr class=\"network\"><th>MQTT Server</th><td colspan=\"4\">%s mqtts://%s:%d</td></tr>", mqttConnected ? "Connected to" : "Disconnected from ", MQTT_SERVER, MQTT_PORT);
+  out.printf("<tr class=\"network\"><th>IP Address</th><td colspan=\"4\">%d.%d.%d.%d</td></tr>", ip[0], ip[1], ip[2], ip[3]);
+  out.printf("<tr class=\"network\"><th>WiFi Signal Strength (%s)</th><td colspan=\"4\">%d dBm</td></tr>", WIFI_SSID, WiFi.RSSI());
 
-  buffer += buffercat(buffer, "</table>"); // Sensor data table
+  out.printf("<tr class=\"chip\"><th>Free Heap Memory</th><td colspan=\"4\">%d bytes</td></tr>", ESP.getFreeHeap()); // ESP32 free heap memory, which indicates if the program still has enough memory to run effectively
+  BatterySnapshot battery = batterySnapshot.read(); // Consistent copy of the battery data (published by a different thread)
+  out.printf("<tr class=\"chip\" id=\"battery\"><th>Battery</th><td colspan=\"4\">%0.2fV / %0.0f%%</td></tr>", battery.voltage, battery.percent); // LiPo battery
+  out.printf("<tr class=\"chip\"><th>AC Power State</th><td colspan=\"4\">%s</td></tr>", battery.acPowerState ? "1 (On)" : "0 (Off)"); // AC power sense
+  out.printf("<tr class=\"chip\"><th>Chip Information</th><td colspan=\"4\">%s</td></tr>", chipInformation);
 
-  return buffer;
+  out.print("</table>"); // Sensor data table
 }
 
 // Web server 404 handler
@@ -272,137 +533,681 @@ void webHandler404()
 // Web server "/" GET handler (for root/home page)
 void webHandlerRoot()
 {
-  // Build the HTML response in the web string buffer
-  char* buffer = webStringBuffer; // "buffer" will be used to walk through the "webStringBuffer" work area using pointer arithmetic
-  buffer += bytesAdded(sprintf(buffer, htmlHeader, WIFI_HOSTNAME, systemSeconds(), BME680_TEMP_F ? "F" : "C")); // Hostname gets added to the HTML <title> inside the template header, and the ESP32 current seconds counter and temperature units are used by JavaScript for the charts
-  buffer  = webRenderDashboard(buffer);
-  buffer += buffercat(buffer, htmlFooter); // HTML template footer
+  // Stream the HTML response to the client
+  WebResponseWriter out(200, "text/html");
+  out.printf(htmlHeader, WIFI_HOSTNAME, htmlAssetCssVersion, systemSeconds(), BME680_TEMP_F ? "F" : "C", dataStreamNames, htmlAssetJsVersion); // Hostname gets added to the HTML <title> inside the template header, and the ESP32 current seconds counter, temperature units and stream names are used by JavaScript for the charts
+  webRenderDashboard(out);
+  out.print(htmlFooter); // HTML template footer
+  out.end();
+}
 
-  // Send the HTML response to the client
-  webServer.send(200, "text/html", webStringBuffer);
+// Helper function to send a gzip-compressed static asset from flash. The asset URLs include the version, so browsers can cache them for a long time,
+// and a browser that revalidates anyway gets a 304 response when its copy is still current. Only the compressed copy is kept in flash, so a client
+// that doesn't accept gzip gets a 406 response.
+void webSendAsset(const char* contentType, const uint8_t* data, size_t size, const char* version)
+{
+  webServer.sendHeader("Vary", "Accept-Encoding"); // Keeps caches from handing the compressed copy to clients that can't decode it
+  if (webServer.header("Accept-Encoding").indexOf("gzip") < 0)
+  {
+    webServer.send(406, "text/plain", "This asset is only available with gzip encoding");
+    return;
+  }
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%s\"", version);
+  webServer.sendHeader("ETag", etag);
+  webServer.sendHeader("Cache-Control", "public, max-age=31536000, immutable");
+  if (webServer.header("If-None-Match") == etag)
+  {
+    webServer.send(304);
+    return;
+  }
+  webServer.sendHeader("Content-Encoding", "gzip");
+  webServer.send_P(200, contentType, (PGM_P)data, size);
 }
 
 // Web server "/dashboard" GET handler (for AJAX updates on the main interface)
 void webHandlerDashboard()
 {
-  webRenderDashboard(webStringBuffer);
-  webServer.send(200, "text/plain", webStringBuffer);
+  WebResponseWriter out(200, "text/plain");
+  webRenderDashboard(out);
+  out.end();
 }
 
-// Helper functions to append one Prometheus style metric to the web buffer, such as the following where name="light_level_lux", description="Light level (current)", format="0.2f", metric=65.0F:
+// Helper function to append one Prometheus style metric to the response, such as the following where name="light_level_lux", description="Light level (current)", format="%0.2f", metric=65.0F:
 //    # HELP light_level_lux Light level (current)
 //    # TYPE light_level_lux gauge
 //    light_level_lux 65.00
-char* webAppendMetric(char* buffer, char* name, char* description, char* format, float metric)
+void webAppendMetric(MetricsWriter& out, const char* name, const char* description, const char* format, float metric)
 {
-  buffer += buffercat(buffer, "# HELP "); buffer += buffercat(buffer, name); buffer += buffercat(buffer, " "); buffer += buffercat(buffer, description); buffer += buffercat(buffer, "\n");
-  buffer += buffercat(buffer, "# TYPE "); buffer += buffercat(buffer, name); buffer += buffercat(buffer, " gauge\n");
-  buffer += buffercat(buffer, name); buffer += buffercat(buffer, " "); buffer += bytesAdded(sprintf(buffer, format, metric)); buffer += buffercat(buffer, "\n\n");
-  return buffer;
+  out.begin(name, description, METRICS_GAUGE);
+  out.sample(format, metric);
 }
 
-// Web server "/metrics" GET handler (for Prometheus and similar telemetry tools)
-// Reference: https://github.com/prometheus/docs/blob/main/content/docs/instrumenting/exposition_formats.md
-void webHandlerMetrics()
+// Name suffixes and description suffixes of the MeasurementTracker summary values, indexed by MeasurementSummary. The names without the underscore are
+// the stat label values in the labeled metrics.
+const char* measurementSummaryNames[MEASUREMENT_SUMMARY_VALUES] = { "_ema", "_p50", "_p95", "_stddev", "_rate" };
+const char* measurementSummaryDescriptions[MEASUREMENT_SUMMARY_VALUES] = {
+  " (exponential moving average)", " (median of the newest half to full window)", " (95th percentile of the newest half to full window)", " (standard deviation)", " (change per window)"
+};
+
+// Helper function to append the summary values that a tracker calculates, such as light_level_lux_p95
+void webAppendSummaryMetrics(MetricsWriter& out, const char* name, const char* description, const char* format, const MeasurementStats& measurement)
 {
-  // Build the HTML response in the web string buffer
-  char* buffer = webStringBuffer; // "buffer" will be used to walk through the "webStringBuffer" work area using pointer arithmetic
+  char summaryName[80], summaryDescription[160];
+  for (int k = 0; k < MEASUREMENT_SUMMARY_VALUES; k++)
+  {
+    if (!(measurement.operators & (1 << k))) continue;
+    snprintf(summaryName, sizeof(summaryName), "%s%s", name, measurementSummaryNames[k]);
+    snprintf(summaryDescription, sizeof(summaryDescription), "%s%s", description, measurementSummaryDescriptions[k]);
+    webAppendMetric(out, summaryName, summaryDescription, format, measurement.summary[k]);
+  }
+}
 
+// Helper function to append the current/min/average/max and summary values from a MeasurementTracker snapshot as one labeled metric, such as:
+//    # HELP light_level_lux Light level
+//    # TYPE light_level_lux gauge
+//    light_level_lux{host="Sensor-Ambient-1",stat="current"} 65.00
+//    light_level_lux{host="Sensor-Ambient-1",stat="min"} 0.50
+//    light_level_lux{host="Sensor-Ambient-1",stat="avg"} 30.25
+//    light_level_lux{host="Sensor-Ambient-1",stat="max"} 80.00
+void webAppendStatsMetric(MetricsWriter& out, const char* name, const char* description, const char* format, const MeasurementStats& measurement)
+{
+  out.begin(name, description, METRICS_GAUGE);
+  out.sample(format, measurement.current, "stat", "current");
+  out.sample(format, measurement.min, "stat", "min");
+  out.sample(format, measurement.average, "stat", "avg");
+  out.sample(format, measurement.max, "stat", "max");
+  for (int k = 0; k < MEASUREMENT_SUMMARY_VALUES; k++)
+  {
+    if (measurement.operators & (1 << k)) out.sample(format, measurement.summary[k], "stat", measurementSummaryNames[k] + 1);
+  }
+}
+
+// Helper macros to expand the published value registries into metrics. In labeled mode, each STATS entry is one metric with a stat label, and
+// otherwise each statistic has its own metric name.
+#define METRIC_STATS(name, description, format, measurement, deadband) \
+  if (out.labeled()) webAppendStatsMetric(out, name, description, format, measurement); \
+  else \
+  { \
+    webAppendMetric(out, name,              description " (current)", format, (measurement).current); \
+    webAppendMetric(out, name "_min",       description " (min)",     format, (measurement).min); \
+    webAppendMetric(out, name "_average",   description " (average)", format, (measurement).average); \
+    webAppendMetric(out, name "_max",       description " (max)",     format, (measurement).max); \
+    webAppendSummaryMetrics(out, name, description, format, measurement); \
+  }
+#define METRIC_VALUE(name, description, format, value, deadband) webAppendMetric(out, name, description, format, (float)(value));
+
+// Metrics renderer for task, latency and memory instrumentation, which is always rendered live
+void webRenderInstrumentationMetrics(MetricsWriter& out)
+{
+  // Tasks
+  struct { const char* name; TaskHandle_t handle; TaskLoad& load; RunTimeShare& share; } tasks[] = {
+    { "loop", taskHandleLoop, taskLoadLoop, taskShareLoop }, { "readI2CDevices", taskHandleI2C, taskLoadI2C, taskShareI2C },
+    { "measureSound", taskHandleSound, taskLoadSound, taskShareSound }, { "serveWeb", taskHandleWeb, taskLoadWeb, taskShareWeb }
+  };
+  #if configGENERATE_RUN_TIME_STATS // CPU time is only known when FreeRTOS keeps the run-time counters
+    uint32_t runTime = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+    out.begin("esp32_task_cpu_percent", "Percent of a CPU core the task ran on since the last scrape (FreeRTOS run-time stats)", METRICS_GAUGE);
+    for (auto& task : tasks) if (task.handle) out.sample("%0.2f", task.share.update((uint32_t)ulTaskGetRunTimeCounter(task.handle), runTime), "task", task.name);
+  #endif
+  out.begin("esp32_task_busy_seconds", "Wall-clock time the task spent on its work, including blocking waits such as sensor delays and socket writes", METRICS_COUNTER);
+  for (auto& task : tasks) out.sample("%0.3f", task.load.busySeconds(), "task", task.name);
+  out.begin("esp32_task_stack_free_min_bytes", "Smallest amount of free stack the task has had (high-water mark)", METRICS_GAUGE);
+  for (auto& task : tasks) if (task.handle) out.sample("%0.0f", uxTaskGetStackHighWaterMark(task.handle), "task", task.name);
+
+  // Sensor read latency
+  out.begin("esp32_sensor_read_seconds", "Time to read each I2C sensor", METRICS_HISTOGRAM);
+  for (I2CDevice& device : i2cDevices) out.histogram(device.latency, "sensor", device.name);
+
+  // HTTP handler render time
+  out.begin("esp32_http_handler_seconds", "Time to render and send each web response", METRICS_HISTOGRAM);
+  for (int h = 0; h < WEB_HANDLERS; h++) out.histogram(webHandlerLatency[h], "handler", webHandlerNames[h]);
+
+  // MQTT publish time
+  out.begin("esp32_mqtt_update_seconds", "Time to build and publish each MQTT update", METRICS_HISTOGRAM);
+  out.histogram(mqttUpdateLatency);
+
+  // MQTT connections
+  out.begin("esp32_mqtt_connect_seconds", "Time to connect to the MQTT broker, including the TLS handshake", METRICS_HISTOGRAM);
+  out.histogram(mqttConnectLatency);
+  out.begin("esp32_mqtt_connect_attempts", "MQTT connection attempts", METRICS_COUNTER);
+  out.sample("%0.0f", mqttConnectAttempts);
+  out.begin("esp32_mqtt_connect_failures", "Failed MQTT connection attempts", METRICS_COUNTER);
+  out.sample("%0.0f", mqttConnectFailures);
+  out.begin("esp32_mqtt_disconnects", "Established MQTT connections that were lost", METRICS_COUNTER);
+  out.sample("%0.0f", mqttDisconnects);
+  webAppendMetric(out, "esp32_mqtt_queue_samples", "Samples waiting to be sent from the MQTT offline queue", "%0.0f", (float)mqttQueuePending);
+  out.begin("esp32_mqtt_queue_dropped", "Queued samples that were overwritten before they could be sent", METRICS_COUNTER);
+  out.sample("%0.0f", mqttQueueDropped);
+
+  // Data log
+  out.begin("esp32_data_log_write_failures", "Failed writes to the flash data log, which are retried with the next batch", METRICS_COUNTER);
+  out.sample("%0.0f", (float)dataLog.writeFailures());
+  out.begin("esp32_data_log_dropped", "Data elements dropped because the flash data log writes kept failing", METRICS_COUNTER);
+  out.sample("%0.0f", (float)dataLog.droppedRecords());
+
+  // Mutex wait time
+  out.begin("esp32_mutex_wait_seconds", "Time spent waiting to take each mutex", METRICS_HISTOGRAM);
+  out.histogram(mutexWaitUptime, "mutex", "uptime");
+  out.histogram(mutexWaitDataSet, "mutex", "dataset");
+
+  // Sound DMA buffers
+  out.begin("esp32_sound_buffer_overruns", "Sound DMA buffers that were overwritten before they were measured", METRICS_COUNTER);
+  out.sample("%0.0f", soundSensorOverruns);
+
+  // Memory
+  webAppendMetric(out, "esp32_heap_size_bytes", "ESP32 total heap memory", "%0.0f", (float)ESP.getHeapSize());
+  webAppendMetric(out, "esp32_heap_free_min_bytes", "ESP32 smallest amount of free heap memory since boot", "%0.0f", (float)ESP.getMinFreeHeap());
+  webAppendMetric(out, "esp32_heap_largest_free_block_bytes", "ESP32 largest free block of heap memory", "%0.0f", (float)ESP.getMaxAllocHeap());
+  webAppendMetric(out, "esp32_psram_size_bytes", "ESP32 total PSRAM", "%0.0f", (float)ESP.getPsramSize());
+  webAppendMetric(out, "esp32_psram_free_bytes", "ESP32 free PSRAM", "%0.0f", (float)ESP.getFreePsram());
+  webAppendMetric(out, "esp32_psram_largest_free_block_bytes", "ESP32 largest free block of PSRAM", "%0.0f", (float)ESP.getMaxAllocPsram());
+  webAppendMetric(out, "esp32_measurement_arena_bytes", "PSRAM used by the min/average/max measurement windows", "%0.0f", (float)measurementArena.bytesUsed());
+}
+
+// Metrics renderer for the environmental sensor section of the "/metrics" response
+void webRenderEnvironmentMetrics(MetricsWriter& out)
+{
   // Environmentals
-  xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data (calculated on a different thread)
-  if (environmentSensorOK)
+  EnvironmentSnapshot environment = environmentSnapshot.read(); // Consistent copy of the environmental data (published by a different thread)
+  if (environment.ok)
   {
-    #ifdef BME680_TEMP_F
-      #define SCRAPE_UNITS "(F)"
-    #else
-      #define SCRAPE_UNITS "(C)"
-    #endif
-    buffer = webAppendMetric(buffer, "environmental_temperature",           "Environment temperature " SCRAPE_UNITS " (current)", "%0.1f", environmentTemperature.current);
-    buffer = webAppendMetric(buffer, "environmental_temperature_min",       "Environment temperature " SCRAPE_UNITS " (min)",     "%0.1f", environmentTemperature.min);
-    buffer = webAppendMetric(buffer, "environmental_temperature_average",   "Environment temperature " SCRAPE_UNITS " (average)", "%0.1f", environmentTemperature.average);
-    buffer = webAppendMetric(buffer, "environmental_temperature_max",       "Environment temperature " SCRAPE_UNITS " (max)",     "%0.1f", environmentTemperature.max);
-    buffer = webAppendMetric(buffer, "environmental_dew_point",             "Environment calculated dew point " SCRAPE_UNITS " (current)", "%0.1f", environmentDewPoint.current);
-    buffer = webAppendMetric(buffer, "environmental_dew_point_min",         "Environment calculated dew point " SCRAPE_UNITS " (min)",     "%0.1f", environmentDewPoint.min);
-    buffer = webAppendMetric(buffer, "environmental_dew_point_average",     "Environment calculated dew point " SCRAPE_UNITS " (average)", "%0.1f", environmentDewPoint.average);
-    buffer = webAppendMetric(buffer, "environmental_dew_point_max",         "Environment calculated dew point " SCRAPE_UNITS " (max)",     "%0.1f", environmentDewPoint.max);
-    buffer = webAppendMetric(buffer, "environmental_humidity",              "Environment humidity (RH%) (current)", "%0.1f", environmentHumidity.current);
-    buffer = webAppendMetric(buffer, "environmental_humidity_min",          "Environment humidity (RH%) (min)",     "%0.1f", environmentHumidity.min);
-    buffer = webAppendMetric(buffer, "environmental_humidity_average",      "Environment humidity (RH%) (average)", "%0.1f", environmentHumidity.average);
-    buffer = webAppendMetric(buffer, "environmental_humidity_max",          "Environment humidity (RH%) (max)",     "%0.1f", environmentHumidity.max);
-    buffer = webAppendMetric(buffer, "environmental_pressure_mbar",         "Environment barometric pressure (current)", "%0.1f", environmentPressure.current);
-    buffer = webAppendMetric(buffer, "environmental_pressure_mbar_min",     "Environment barometric pressure (min)",     "%0.1f", environmentPressure.min);
-    buffer = webAppendMetric(buffer, "environmental_pressure_mbar_average", "Environment barometric pressure (average)", "%0.1f", environmentPressure.average);
-    buffer = webAppendMetric(buffer, "environmental_pressure_mbar_max",     "Environment barometric pressure (max)",     "%0.1f", environmentPressure.max);
+    PUBLISH_ENVIRONMENT(METRIC_STATS, METRIC_VALUE)
 
     // IAQ metrics
-    if (environmentIAQAccuracy)
+    if (environment.iaqAccuracy)
     {
-      buffer = webAppendMetric(buffer, "environmental_iaq",         "Environment IAQ (0-100%, 0%=bad, 100%=good) (current)", "%0.2f", environmentIAQ.current);
-      buffer = webAppendMetric(buffer, "environmental_iaq_min",     "Environment IAQ (0-100%, 0%=bad, 100%=good) (min)",     "%0.2f", environmentIAQ.min);
-      buffer = webAppendMetric(buffer, "environmental_iaq_average", "Environment IAQ (0-100%, 0%=bad, 100%=good) (average)", "%0.2f", environmentIAQ.average);
-      buffer = webAppendMetric(buffer, "environmental_iaq_max",     "Environment IAQ (0-100%, 0%=bad, 100%=good) (max)",     "%0.2f", environmentIAQ.max);
+      PUBLISH_IAQ(METRIC_STATS, METRIC_VALUE)
     }
-    buffer = webAppendMetric(buffer, "environmental_iaq_accuracy",             "Environment IAQ accuracy (0=unreliable, 1=low, 2=medium, 3=high, 4=very high)", " %0.0f", (float)environmentIAQAccuracy);
-    buffer = webAppendMetric(buffer, "environmental_gas_resistance_ohms",      "Environment gas resistance", " %0.0f", (float)environmentGasResistance);
-    buffer = webAppendMetric(buffer, "environmental_gas_calibration_accuracy", "Environment gas calibration accuracy (0-100%, 0%=bad, 100%=good)", " %0.1f", environmentGasAccuracy);
+    PUBLISH_GAS(METRIC_STATS, METRIC_VALUE)
   }
-  xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
+}
 
-  // Sound level
-  xSemaphoreTake(xMutexSoundSensor, portMAX_DELAY); // Start accessing sound data (measured on a different thread)
-  buffer = webAppendMetric(buffer, "sound_level_db",         "Sound pressure level (current)", "%0.2f", soundSensorSpl.current);
-  buffer = webAppendMetric(buffer, "sound_level_db_min",     "Sound pressure level (min)",     "%0.2f", soundSensorSpl.min);
-  buffer = webAppendMetric(buffer, "sound_level_db_average", "Sound pressure level (average)", "%0.2f", soundSensorSpl.average);
-  buffer = webAppendMetric(buffer, "sound_level_db_max",     "Sound pressure level (max)",     "%0.2f", soundSensorSpl.max);
-  xSemaphoreGive(xMutexSoundSensor); // Done with sound data
+// Metrics renderer for the sound level section of the "/metrics" response
+void webRenderSoundMetrics(MetricsWriter& out)
+{
+  SoundSnapshot sound = soundSnapshot.read(); // Consistent copy of the sound data (published by a different thread)
+  PUBLISH_SOUND(METRIC_STATS, METRIC_VALUE)
+}
 
-  // Light level
-  xSemaphoreTake(xMutexLightSensor, portMAX_DELAY); // Start accessing light data (measured on a different thread)
-  buffer = webAppendMetric(buffer, "light_level_lux",         "Light level (current)", "%0.2f", lightSensorLux.current);
-  buffer = webAppendMetric(buffer, "light_level_lux_min",     "Light level (min)",     "%0.2f", lightSensorLux.min);
-  buffer = webAppendMetric(buffer, "light_level_lux_average", "Light level (average)", "%0.2f", lightSensorLux.average);
-  buffer = webAppendMetric(buffer, "light_level_lux_max",     "Light level (max)",     "%0.2f", lightSensorLux.max);
-  buffer = webAppendMetric(buffer, "light_level_measurement_gain", "Light measurement gain", " %0.3f", lightSensorGain);
-  buffer = webAppendMetric(buffer, "light_level_measurement_integration_time_ms", "Light measurement integration time", " %0.0f", (float)lightSensorIntegrationTime);
-  xSemaphoreGive(xMutexLightSensor); // Done with light data
+// Metrics renderer for the light level section of the "/metrics" response
+void webRenderLightMetrics(MetricsWriter& out)
+{
+  LightSnapshot light = lightSnapshot.read(); // Consistent copy of the light data (published by a different thread)
+  PUBLISH_LIGHT(METRIC_STATS, METRIC_VALUE)
+}
+
+// Metrics renderer for the battery and AC power section of the "/metrics" response
+void webRenderBatteryMetrics(MetricsWriter& out)
+{
+  BatterySnapshot battery = batterySnapshot.read(); // Consistent copy of the battery data (published by a different thread)
+  PUBLISH_BATTERY(METRIC_STATS, METRIC_VALUE)
+  webAppendMetric(out, "esp32_battery_charge_rate_percent_per_hour", "ESP32 LiPo battery charge rate, negative while discharging", "%0.2f", battery.chargeRate);
+  float runtime = battery.chargeRate < -0.01F ? battery.percent / -battery.chargeRate * 3600.0F : NAN; // Only known while discharging
+  webAppendMetric(out, "esp32_battery_runtime_estimate_seconds", "ESP32 estimated battery runtime at the current discharge rate", "%0.0f", runtime);
+  webAppendMetric(out, "esp32_power_save_mode", "ESP32 power save mode, used while running on the battery", "%0.0f", (float)powerSaveMode);
+}
+
+// Web server "/metrics" GET handler (for Prometheus and similar telemetry tools)
+// Reference: https://github.com/prometheus/docs/blob/main/content/docs/instrumenting/exposition_formats.md
+// The sensor sections are cached, and each one is only rendered again after its measurement function publishes new values. Scrapes in between send
+// the cached text without reading the sensor snapshots.
+void webHandlerMetrics()
+{
+  static void (*const renderers[METRICS_SECTIONS])(MetricsWriter&) = { webRenderEnvironmentMetrics, webRenderSoundMetrics, webRenderLightMetrics, webRenderBatteryMetrics };
+
+  // Pick the exposition format from the Accept header. Prometheus lists the formats it prefers first, and protobuf is only listed when it's wanted.
+  String accept = webServer.header("Accept");
+  MetricsFormat format = METRICS_FORMAT_TEXT;
+  if (METRICS_PROTOBUF && accept.indexOf("application/vnd.google.protobuf") >= 0 && accept.indexOf("io.prometheus.client.MetricFamily") >= 0) format = METRICS_FORMAT_PROTOBUF;
+  else if (METRICS_OPENMETRICS && accept.indexOf("application/openmetrics-text") >= 0) format = METRICS_FORMAT_OPENMETRICS;
+  const char* host = format != METRICS_FORMAT_TEXT || METRICS_LABELS ? WIFI_HOSTNAME : nullptr; // The labeled formats add the host label
+  const char* contentType = format == METRICS_FORMAT_PROTOBUF ? METRICS_CONTENT_PROTOBUF : format == METRICS_FORMAT_OPENMETRICS ? METRICS_CONTENT_OPENMETRICS : METRICS_CONTENT_TEXT;
+
+  // Render the sensor sections again when they change or when a different format is asked for. This is done before anything is sent, so a section
+  // that couldn't be rendered for lack of memory gets an error response instead of a truncated or corrupt one.
+  for (int section = 0; section < METRICS_SECTIONS; section++)
+  {
+    if (!metricsDirty[section] && metricsCacheFormat[section] == format) continue;
+    metricsDirty[section] = false; // Clear the flag first, so values published while rendering mark the section dirty again
+    metricsCacheFormat[section] = format;
+    metricsCache[section].clear();
+    bool failed;
+    {
+      MetricsWriter cache(metricsCache[section], format, host, &metricsFamily);
+      renderers[section](cache);
+      cache.finish();
+      failed = cache.failed();
+    }
+    metricsCache[section].flush();
+    if (failed || metricsCache[section].overflowed())
+    {
+      metricsDirty[section] = true; // Try again on the next scrape
+      webServer.send(503, "text/plain", "Out of memory");
+      return;
+    }
+  }
+
+  // Stream the response to the client. A live family that doesn't fit in memory is left out, which keeps the rest of the response valid.
+  WebResponseWriter response(200, contentType);
+  MetricsWriter out(response, format, host, &metricsFamily);
+  for (int section = 0; section < METRICS_SECTIONS; section++) response.write(metricsCache[section].data(), metricsCache[section].size());
 
   // Measurement window
-  buffer = webAppendMetric(buffer, "measurement_window_seconds", "Measurement Window for min/average/max calculations", " %0.0f", (float)MEASUREMENT_WINDOW);
+  webAppendMetric(out, "measurement_window_seconds", "Measurement Window for min/average/max calculations", "%0.0f", (float)MEASUREMENT_WINDOW);
 
   // WiFi signal strength
-  buffer += buffercat(buffer, "# HELP esp32_wifi_signal_strength ESP32 WiFi signal strength\n");
-  buffer += buffercat(buffer, "# TYPE esp32_wifi_signal_strength gauge\n");
-  buffer += bytesAdded(sprintf(buffer, "esp32_wifi_signal_strength{SSID=\"%s\"} %d\n\n", WIFI_SSID, WiFi.RSSI()));
+  out.begin("esp32_wifi_signal_strength", "ESP32 WiFi signal strength", METRICS_GAUGE);
+  out.sample("%0.0f", WiFi.RSSI(), "SSID", WIFI_SSID);
 
   // Free heap memory
-  buffer = webAppendMetric(buffer, "esp32_free_heap_bytes", "ESP32 free heap memory", " %0.0f", (float)ESP.getFreeHeap());
+  webAppendMetric(out, "esp32_free_heap_bytes", "ESP32 free heap memory", "%0.0f", (float)ESP.getFreeHeap());
 
-  // Battery data and AC power on/off state
-  xSemaphoreTake(xMutexBattery, portMAX_DELAY); // Start accessing the battery data
-  buffer = webAppendMetric(buffer, "esp32_battery_voltage", "ESP32 LiPo battery voltage", " %0.2f", batteryVoltage);
-  buffer = webAppendMetric(buffer, "esp32_battery_percent", "ESP32 LiPo battery percent", " %0.2f", batteryPercent);
-  buffer = webAppendMetric(buffer, "esp32_ac_power_state", "ESP32 AC power state", " %0.0f", (float)acPowerState);
-  xSemaphoreGive(xMutexBattery); // Done with battery data
+  // Instrumentation
+  webRenderInstrumentationMetrics(out);
 
   // Chip information
-  buffer += buffercat(buffer, "# HELP esp32_chip_information ESP32 chip information\n");
-  buffer += buffercat(buffer, "# TYPE esp32_chip_information gauge\n");
-  buffer += bytesAdded(sprintf(buffer, "esp32_chip_information{version=\"%s\"} 1\n\n", chipInformation));
+  out.begin("esp32_chip_information", "ESP32 chip information", METRICS_GAUGE);
+  out.sample("%0.0f", 1, "version", chipInformation);
+
+  // The text format ends with a line feed character, and OpenMetrics with an EOF line
+  out.end();
+  response.end();
+}
+
+// Helper function to read one chart data value from a tier. The raw tier holds one value per stream, and the rollup tiers hold min/average/max values.
+inline float webDataValue(const DataHistory& tier, int stat, int stream, int i)
+{
+  return &tier == &psramDataSet ? tier.value(stream, i) : tier.value(stream * DATA_ROLLUP_STATS + stat, i);
+}
+
+// Helper function to select the chart data tier and statistic from the "resolution" and "stat" query parameters
+DataHistory& webSelectDataTier(int& stat)
+{
+  String statName = webServer.arg("stat");
+  stat = statName == "min" ? DATA_ROLLUP_MIN : statName == "max" ? DATA_ROLLUP_MAX : DATA_ROLLUP_AVG;
+  String resolution = webServer.arg("resolution");
+  if (resolution == "15m") return psramDataSet15m;
+  if (resolution == "1d") return psramDataSetDaily;
+  return psramDataSet;
+}
+
+// Helper function to copy elements of one chart data stream out of a tier, starting at the specified sequence number. The data set mutex is only held
+// while copying, never while sending to a client. Elements that were overwritten since the response started are returned as missing values.
+void webCopyDataStream(const DataHistory& tier, int stat, int stream, uint32_t sequence, int count, float* values, int32_t* times)
+{
+  takeMutex(xMutexDataSet, mutexWaitDataSet); // Start accessing the data tiers
+  for (int k = 0; k < count; k++)
+  {
+    int i = tier.indexOf(sequence + k);
+    if (stream == DATA_STREAM_TIME)
+    {
+      times[k] = i < 0 ? 0 : tier.time(i);
+    }
+    else
+    {
+      values[k] = i < 0 ? NAN : webDataValue(tier, stat, stream, i);
+    }
+  }
+  xSemaphoreGive(xMutexDataSet); // Done with the data tiers
+}
+
+// Helper function to find the range of elements to send from a tier, which is every element newer than the "since" query parameter when present.
+// Returns the number of elements, and the sequence number of the first one.
+int webFindDataRange(const DataHistory& tier, uint32_t& first)
+{
+  takeMutex(xMutexDataSet, mutexWaitDataSet); // Start accessing the data tiers
+  int n = tier.size();
+  int i = 0;
+  if (webServer.hasArg("since"))
+  {
+    // New elements are at the end, so search backwards
+    int32_t since = webServer.arg("since").toInt();
+    i = n;
+    while (i > 0 && tier.time(i - 1) > since) i--;
+  }
+  else if (n == tier.maxSize() && n > 1)
+  {
+    i = 1; // The tier is full, so leave the oldest element out because it's the next one to be overwritten while the response is being sent
+  }
+  first = tier.firstSequence() + i;
+  xSemaphoreGive(xMutexDataSet); // Done with the data tiers
+  return n - i;
+}
+
+// Helper function to encode chart data values as binary words (see DataEncoding.h), continuing from the quantized value of the previous non-null element.
+// Returns the number of words written, which is at most 3 per value.
+int webEncodeDataValues(int16_t* words, int stream, const float* values, const int32_t* times, int count, int32_t& previous)
+{
+  if (stream == DATA_STREAM_TIME) return dataEncodeTimes(words, times, count, previous); // Time index
+  return dataEncodeValues(words, values, count, dataStreamScale[stream], previous);
+}
 
-  // Last line must end with a line feed character
-  buffer += buffercat(buffer, "\n");
+// Web handler for compact binary chart data, used by the web page. All values are little-endian:
+//    Header:  uint16 version, uint16 stream count, uint32 point count, int32 current time index, uint32 tier capacity (such as DATA_HISTORY_COUNT)
+//    Streams: uint16 stream number, uint16 statistic (0=min, 1=average, 2=max), float32 scale, uint32 word count, followed by that many int16 words
+// Each word is the change in the quantized stream value (value / scale) since the previous non-null element, starting from zero, or DATA_BINARY_NULL for a
+// missing value, or DATA_BINARY_ESCAPE followed by two words holding the absolute quantized value as an int32 (low word first).
+// Optional query parameters:
+//    since=<time index>    Only send elements newer than the specified time index, such as the last time index the client already has
+//    streams=<n,n,...>     Only send the specified streams, numbered in the same order as the text format (the time index is stream 9)
+//    resolution=15m or 1d  Send a rollup tier instead of the raw data, where each element covers 15 minutes or one day
+//    stat=min, avg or max  Statistic to send from a rollup tier (default is avg)
+void webHandlerDataBinary()
+{
+  int stat;
+  DataHistory& tier = webSelectDataTier(stat);
+
+  // Parse the stream selection
+  int streams[DATA_STREAM_COUNT];
+  int streamCount = 0;
+  if (webServer.hasArg("streams"))
+  {
+    String list = webServer.arg("streams");
+    const char* p = list.c_str();
+    while (*p && streamCount < DATA_STREAM_COUNT)
+    {
+      char* end;
+      long stream = strtol(p, &end, 10);
+      if (end == p) break; // Not a number
+      if (stream >= 0 && stream < DATA_STREAM_COUNT) streams[streamCount++] = stream;
+      p = *end == ',' ? end + 1 : end;
+    }
+  }
+  else
+  {
+    for (int stream = 0; stream < DATA_STREAM_COUNT; stream++) streams[streamCount++] = stream;
+  }
 
-  // Send the HTML response to the client
-  webServer.send(200, "text/plain", webStringBuffer);
+  // Each stream is encoded into a work buffer before it's sent, because its word count comes first
+  uint32_t first;
+  int n = webFindDataRange(tier, first);
+  int16_t* words = (int16_t*)ps_malloc((n * 3 + 1) * sizeof(int16_t));
+  if (!words)
+  {
+    webServer.send(503, "text/plain", "Out of memory");
+    return;
+  }
+
+  // Send the header, then each stream
+  WebResponseWriter out(200, "application/octet-stream");
+  struct { uint16_t version; uint16_t streamCount; uint32_t pointCount; int32_t time; uint32_t historyCount; } header = { 1, (uint16_t)streamCount, (uint32_t)n, (int32_t)timer, (uint32_t)tier.maxSize() };
+  out.write((const char*)&header, sizeof(header));
+  for (int s = 0; s < streamCount; s++)
+  {
+    float values[DATA_COPY_BATCH];
+    int32_t times[DATA_COPY_BATCH];
+    int32_t previous = 0;
+    uint32_t count = 0;
+    for (int i = 0; i < n; i += DATA_COPY_BATCH)
+    {
+      int m = n - i < DATA_COPY_BATCH ? n - i : DATA_COPY_BATCH;
+      webCopyDataStream(tier, stat, streams[s], first + i, m, values, times);
+      count += webEncodeDataValues(words + count, streams[s], values, times, m, previous);
+    }
+    struct { uint16_t stream; uint16_t stat; float scale; uint32_t words; } descriptor = { (uint16_t)streams[s], (uint16_t)stat, dataStreamScale[streams[s]], count };
+    out.write((const char*)&descriptor, sizeof(descriptor));
+    out.write((const char*)words, count * sizeof(int16_t));
+  }
+  out.end();
+  free(words);
 }
 
-// Web handler for chart data. Sends all data streams as a single text/plain data set.
+// Web handler for chart data. Sends all data streams as a single text/plain data set of comma-delimited values, one stream after another.
+// The binary data set is formatted on the fly and streamed to the client. Use "format=binary" for the compact binary format. The "resolution"
+// and "stat" query parameters described above also apply to the text format.
 void webHandlerData()
 {
-  if (psramDataSet)
+  if (webServer.hasArg("format") && webServer.arg("format") == "binary")
+  {
+    webHandlerDataBinary();
+    return;
+  }
+
+  int stat;
+  DataHistory& tier = webSelectDataTier(stat);
+  uint32_t first;
+  int n = webFindDataRange(tier, first);
+  WebResponseWriter out(200, "text/plain");
+  for (int stream = 0; stream < DATA_STREAM_COUNT; stream++)
+  {
+    float values[DATA_COPY_BATCH];
+    int32_t times[DATA_COPY_BATCH];
+    for (int i = 0; i < n; i += DATA_COPY_BATCH)
+    {
+      int m = n - i < DATA_COPY_BATCH ? n - i : DATA_COPY_BATCH;
+      webCopyDataStream(tier, stat, stream, first + i, m, values, times);
+      if (stream == DATA_STREAM_TIME) dataFormatTimes(out, times, m); // Time index
+      else dataFormatValues(out, values, m); // Missing values are sent as JavaScript NULL values
+    }
+  }
+  out.end();
+}
+
+// Server-sent events ("/events") push changed dashboard values and new chart data points to the web page as they are published. The web server
+// library handles one request at a time, so each event client's connection is kept here after its request has been answered, and the web task
+// writes the events to it directly. Values are sent as "live" events holding a JSON object of row ID to an array of numbers, which replace the
+// numbers in that dashboard row in order, and "data" events holding each new raw data element. Each client has its own backlog of bytes to send and
+// its own position in the raw data. The backlog is sent with non-blocking socket writes (WiFiClient::write() waits for a full socket for seconds),
+// so a slow client doesn't hold up the other clients or the web requests, and a client that stops taking data is dropped.
+struct WebEventClient
+{
+  WiFiClient client;
+  bool connected = false;         // True when the slot holds a client
+  BufferWriter backlog;           // Event bytes that haven't been sent yet
+  size_t sent = 0;                // Number of backlog bytes that have been sent
+  uint32_t dataSequence = 0;      // Sequence number of the next raw data element to send
+  unsigned long lastProgress = 0; // Time the client last took some bytes, or had nothing waiting
+};
+WebEventClient webEventClients[WEB_EVENT_CLIENTS]; // Event client slots
+BufferWriter webEventBuffer;                  // Work area for the "live" event, which is the same for every client
+uint32_t webEventVersions[4] = {};            // Last snapshot versions sent: environment, sound, light, battery
+unsigned long webEventLastCheck = 0;          // Time of the last check for new values
+unsigned long webEventLastSend = 0;           // Time of the last event or keepalive
+
+// Helper function to append a number to an event, sending missing values as JSON NULL values
+void webEventNumber(ResponseWriter& out, float value, bool comma)
+{
+  if (isfinite(value)) out.printf(comma ? "%0.3f," : "%0.3f", value); else out.print(comma ? "null," : "null");
+}
+
+// Helper function to append the min/max/average/current values of a measurement row to a "live" event, in the same order as the table columns
+void webEventStats(ResponseWriter& out, const char* id, const MeasurementStats& measurement)
+{
+  out.printf("\"%s\":[", id);
+  webEventNumber(out, measurement.min, true);
+  webEventNumber(out, measurement.max, true);
+  webEventNumber(out, measurement.average, true);
+  webEventNumber(out, measurement.current, false);
+  out.print("],");
+}
+
+// Close an event client and free its slot
+void webEventDrop(WebEventClient& c)
+{
+  c.client.stop();
+  c.client = WiFiClient();
+  c.connected = false;
+  c.backlog.clear();
+  c.sent = 0;
+}
+
+// Send as much of a client's backlog as its socket takes without waiting, and drop the client when it has disconnected or stopped taking data
+void webEventFlush(WebEventClient& c)
+{
+  c.backlog.flush();
+  if (c.backlog.overflowed())
+  {
+    webEventDrop(c); // Part of an event was lost, so the stream can't be continued
+    return;
+  }
+  while (c.sent < c.backlog.size())
+  {
+    int n = send(c.client.fd(), c.backlog.data() + c.sent, c.backlog.size() - c.sent, MSG_DONTWAIT);
+    if (n > 0)
+    {
+      c.sent += n;
+      c.lastProgress = millis();
+    }
+    else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; // The socket's send buffer is full
+    else
+    {
+      webEventDrop(c); // Closed or failed
+      return;
+    }
+  }
+  if (c.sent >= c.backlog.size())
+  {
+    c.backlog.clear();
+    c.sent = 0;
+    c.lastProgress = millis();
+  }
+  else if (c.backlog.size() - c.sent > WEB_EVENT_BACKLOG || millis() - c.lastProgress >= WEB_EVENT_STALL) webEventDrop(c);
+}
+
+// Render a "live" event with the values that have changed since the last one, or with everything when "all" is true. Returns false when nothing changed.
+bool webRenderLiveEvent(ResponseWriter& out, bool all)
+{
+  uint32_t versions[4] = { environmentSnapshot.version(), soundSnapshot.version(), lightSnapshot.version(), batterySnapshot.version() };
+  bool changed[4];
+  bool any = false;
+  for (int k = 0; k < 4; k++)
+  {
+    changed[k] = all || versions[k] != webEventVersions[k];
+    any |= changed[k];
+    if (!all) webEventVersions[k] = versions[k]; // A full event is only for a new client, so the others still get the changes
+  }
+  if (!any) return false;
+
+  out.print("event: live\ndata: {");
+  if (changed[0])
+  {
+    EnvironmentSnapshot environment = environmentSnapshot.read(); // Consistent copy of the environmental data (published by a different thread)
+    if (environment.ok)
+    {
+      webEventStats(out, "temperature", environment.temperature);
+      webEventStats(out, "dewpoint", environment.dewPoint);
+      webEventStats(out, "humidity", environment.humidity);
+      webEventStats(out, "pressure", environment.pressure);
+      webEventStats(out, "iaq", environment.iaq);
+      out.printf("\"gas\":[%u],", (unsigned int)environment.gasResistance);
+      out.print("\"gasaccuracy\":["); webEventNumber(out, environment.gasAccuracy, false); out.print("],");
+    }
+  }
+  if (changed[1])
+  {
+    SoundSnapshot sound = soundSnapshot.read(); // Consistent copy of the sound data (published by a different thread)
+    webEventStats(out, "sound", sound.spl);
+    out.print("\"leq\":["); webEventNumber(out, sound.leq, true); webEventNumber(out, sound.lmax, true); webEventNumber(out, sound.l90, false); out.print("],");
+  }
+  if (changed[2])
+  {
+    LightSnapshot light = lightSnapshot.read(); // Consistent copy of the light data (published by a different thread)
+    webEventStats(out, "light", light.lux);
+    out.print("\"lightgain\":["); webEventNumber(out, light.gain, false); out.print("],");
+    out.printf("\"lightintegration\":[%d],", light.integrationTime);
+  }
+  if (changed[3])
+  {
+    BatterySnapshot battery = batterySnapshot.read(); // Consistent copy of the battery data (published by a different thread)
+    out.print("\"battery\":["); webEventNumber(out, battery.voltage, true); webEventNumber(out, battery.percent, false); out.print("],");
+  }
+  out.print("\"\":0}\n\n"); // Placeholder member, so every value above can end with a comma
+  return true;
+}
+
+// Render a "data" event, as {"t":<time index>,"v":[<value per stream>]}, for each raw data element from the specified sequence number on, and advance
+// the sequence number past them. Elements that were overwritten before they could be sent are skipped.
+void webRenderDataEvents(ResponseWriter& out, uint32_t& sequence)
+{
+  float sample[DATA_VALUE_STREAMS];
+  while (true)
+  {
+    takeMutex(xMutexDataSet, mutexWaitDataSet); // Start accessing the data tiers
+    if ((int32_t)(sequence - psramDataSet.firstSequence()) < 0) sequence = psramDataSet.firstSequence();
+    int i = psramDataSet.indexOf(sequence);
+    int32_t time = 0;
+    if (i >= 0)
+    {
+      for (int s = 0; s < DATA_VALUE_STREAMS; s++) sample[s] = psramDataSet.value(s, i);
+      time = psramDataSet.time(i);
+      sequence++;
+    }
+    xSemaphoreGive(xMutexDataSet); // Done with the data tiers
+    if (i < 0) return;
+
+    out.printf("event: data\ndata: {\"t\":%d,\"v\":[", (int)time);
+    for (int s = 0; s < DATA_VALUE_STREAMS; s++) webEventNumber(out, sample[s], s < DATA_VALUE_STREAMS - 1);
+    out.print("]}\n\n");
+  }
+}
+
+// Push new values to the event clients. Called from the web task between requests.
+void webPushEvents()
+{
+  if (millis() - webEventLastCheck < WEB_EVENT_INTERVAL) return;
+  webEventLastCheck = millis();
+  bool clients = false;
+  for (WebEventClient& c : webEventClients) clients |= c.connected;
+  if (!clients) return;
+
+  // Add the new events to each client's backlog, and send what each socket takes
+  webEventBuffer.clear();
+  bool live = webRenderLiveEvent(webEventBuffer, false);
+  webEventBuffer.flush();
+  bool keepalive = millis() - webEventLastSend >= WEB_EVENT_KEEPALIVE;
+  bool queued = false;
+  for (WebEventClient& c : webEventClients)
   {
-    webServer.send(200, "text/plain", (const char*) psramDataSet);
+    if (!c.connected) continue;
+    if (!c.client.connected())
+    {
+      webEventDrop(c);
+      continue;
+    }
+    if (live) c.backlog.write(webEventBuffer.data(), webEventBuffer.size());
+    if (psramDataSet.ready()) webRenderDataEvents(c.backlog, c.dataSequence);
+    c.backlog.flush();
+    if (keepalive && c.backlog.size() == c.sent) c.backlog.print(": keepalive\n\n");
+    queued |= c.backlog.size() > c.sent;
+    webEventFlush(c);
   }
+  if (queued) webEventLastSend = millis();
+}
+
+// Web server "/events" GET handler, which keeps the connection for server-sent events (see above). When every slot is in use, the oldest client is replaced.
+void webHandlerEvents()
+{
+  static int next = 0;
+  int slot = -1;
+  for (int c = 0; c < WEB_EVENT_CLIENTS && slot < 0; c++)
+  {
+    if (!webEventClients[c].connected) slot = c;
+  }
+  if (slot < 0)
+  {
+    slot = next;
+    next = (next + 1) % WEB_EVENT_CLIENTS;
+  }
+  WebEventClient& c = webEventClients[slot];
+  webEventDrop(c);
+
+  c.client = webServer.client();
+  c.client.setNoDelay(true);
+  c.client.print("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nAccess-Control-Allow-Origin: *\r\n\r\nretry: 5000\n\n");
+  c.connected = true;
+  c.lastProgress = millis();
+
+  // Start the new client with every current value, and with the next new data element. The page fetches the elements it doesn't have from "/data"
+  // when the connection opens.
+  if (psramDataSet.ready())
+  {
+    takeMutex(xMutexDataSet, mutexWaitDataSet);
+    c.dataSequence = psramDataSet.firstSequence() + psramDataSet.size();
+    xSemaphoreGive(xMutexDataSet);
+  }
+  webRenderLiveEvent(c.backlog, true);
+  webEventFlush(c);
 }
 
 // Web server setup 
@@ -412,16 +1217,35 @@ void setupWebserver()
 
   // Set features and URI handlers
   webServer.enableCORS();
-  webServer.on("/", webHandlerRoot);
-  webServer.on("/dashboard", webHandlerDashboard);
-  webServer.on("/data", webHandlerData);
-  webServer.on("/metrics", webHandlerMetrics);
+  const char* headers[] = { "If-None-Match", "Accept", "Accept-Encoding" }; // Request headers used by the handlers
+  webServer.collectHeaders(headers, sizeof(headers) / sizeof(headers[0]));
+  webServer.on("/",          []() { LatencyTimer t(webHandlerLatency[WEB_HANDLER_ROOT]);      webHandlerRoot(); });
+  webServer.on("/dashboard", []() { LatencyTimer t(webHandlerLatency[WEB_HANDLER_DASHBOARD]); webHandlerDashboard(); });
+  webServer.on("/data",      []() { LatencyTimer t(webHandlerLatency[WEB_HANDLER_DATA]);      webHandlerData(); });
+  webServer.on("/metrics",   []() { LatencyTimer t(webHandlerLatency[WEB_HANDLER_METRICS]);   webHandlerMetrics(); });
+  webServer.on("/events",    webHandlerEvents);
+  webServer.on("/app.css",   []() { LatencyTimer t(webHandlerLatency[WEB_HANDLER_ASSET]);     webSendAsset("text/css", htmlAssetCss, htmlAssetCssSize, htmlAssetCssVersion); });
+  webServer.on("/app.js",    []() { LatencyTimer t(webHandlerLatency[WEB_HANDLER_ASSET]);     webSendAsset("application/javascript", htmlAssetJs, htmlAssetJsSize, htmlAssetJsVersion); });
   webServer.onNotFound(webHandler404);
 
-  // Start the server
+  // Start the server. Requests are handled by the serveWeb() task.
   webServer.begin();
 }
 
+// Handle web requests on a separate task, so slow clients don't hold up the display, MQTT or data updates in the main loop
+void serveWeb(void *parameter)
+{
+  // Infinite loop since this is a separate task from the main thread
+  while (true)
+  {
+    taskLoadWeb.begin();
+    webServer.handleClient();
+    webPushEvents();
+    taskLoadWeb.end();
+    delay(2); // Non-blocking delay on ESP32, in milliseconds
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // MQTT
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -434,147 +1258,230 @@ void setupMQTT()
   //espClient.setPrivateKey(const char *CERT_CLIENT_KEY); // Client certificate key
   //espClient.setInsecure(); //TODO: Add switch to allow for testing
   mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
+  mqttClient.setKeepAlive(MQTT_KEEPALIVE); // Keep the connection (and its TLS session) open through idle periods
 }
 
-// Connect/Reconnect to the MQTT server
+// Connect/Reconnect to the MQTT server. Each connection costs a full TLS handshake, so failed attempts back off from MQTT_RECONNECT_MIN to
+// MQTT_RECONNECT_MAX seconds, and no attempt is made while WiFi is down. The first attempt after a dropped connection is made right away.
 void connectMQTT()
 {
-  // Wait a few seconds between connection attempts
-  if (mqttLastConnectionAttempt == 0 || millis() - mqttLastConnectionAttempt >= 15000)
+  if (mqttWasConnected)
+  {
+    Serial.println("MQTT: Connection lost");
+    mqttWasConnected = false;
+    mqttDisconnects++;
+  }
+  if (WiFi.status() != WL_CONNECTED) return;
+  if (mqttLastConnectionAttempt != 0 && millis() - mqttLastConnectionAttempt < mqttReconnectDelay) return;
+  mqttLastConnectionAttempt = millis();
+
+  // Attempt the connection
+  //Serial.println("MQTT: Initializing connection");
+  mqttConnectAttempts++;
+  bool connected;
+  {
+    LatencyTimer latency(mqttConnectLatency);
+    connected = mqttClient.connect(WIFI_HOSTNAME, MQTT_USER, MQTT_PASSWORD);
+  }
+  if (connected)
+  {
+    Serial.println("MQTT: Connected");
+    mqttWasConnected = true;
+    mqttReconnectDelay = 0;
+    lastUpdateTimeMqtt = 0; // Refresh every retained value right away
+  }
+  else
+  {
+    mqttConnectFailures++;
+    mqttReconnectDelay = mqttReconnectDelay ? mqttReconnectDelay * 2 : MQTT_RECONNECT_MIN * 1000UL;
+    if (mqttReconnectDelay > MQTT_RECONNECT_MAX * 1000UL) mqttReconnectDelay = MQTT_RECONNECT_MAX * 1000UL;
+    Serial.print("MQTT: Connection failed: ");
+    Serial.println(mqttClient.state()); // -1=disconnected, -2=connect failed, -3=connection lost, -4=connection timeout
+  }
+}
+
+// Helper function to decide if a value should be published, which is on the heartbeat, the first time, or when it has changed by more than the larger of
+// the absolute deadband or the relative deadband times the last published value. The last published value is updated when this returns true.
+bool mqttChanged(MqttReport& report, bool heartbeat, float value, float absolute, float relative)
+{
+  bool changed;
+  if (heartbeat || !report.published) changed = true;
+  else if (value == report.value) changed = false;
+  else if (isnan(value) || isnan(report.value)) changed = true;
+  else changed = !(fabsf(value - report.value) <= fmaxf(absolute, relative * fabsf(report.value))); // Also true when moving to or from an infinite value
+  if (changed)
   {
-    mqttLastConnectionAttempt = millis();
+    report.value = value;
+    report.published = true;
+    mqttChangeCount++;
+  }
+  return changed;
+}
 
-    // Attempt the connection
-    //Serial.println("MQTT: Initializing connection");
-    if (mqttClient.connect(WIFI_HOSTNAME, MQTT_USER, MQTT_PASSWORD))
+// Helper function to publish one formatted value to its own MQTT topic if it changed, and add it to the JSON state document. "topic" starts with MQTT_TOPIC_BASE,
+// and the rest of the topic is used as the JSON key. Numeric values that aren't finite are added to the JSON document as null.
+void mqttPublishValue(const char* topic, const char* value, bool quoted, bool changed)
+{
+  if (MQTT_PUBLISH_FIELDS && changed)
+  {
+    mqttClient.publish(topic, value, true);
+  }
+  if (MQTT_PUBLISH_STATE)
+  {
+    mqttState.print(mqttStateCount++ ? ",\"" : "\"");
+    mqttState.print(topic + strlen(MQTT_TOPIC_BASE));
+    mqttState.print("\":");
+    if (quoted)
     {
-      Serial.println("MQTT: Connected");
+      mqttState.print("\"");
+      for (const char* c = value; *c; c++)
+      {
+        if (*c == '"' || *c == '\\') mqttState.write("\\", 1);
+        mqttState.write(c, 1);
+      }
+      mqttState.print("\"");
     }
     else
     {
-      Serial.print("MQTT: Connection failed: ");
-      Serial.println(mqttClient.state()); // -1=disconnected, -2=connect failed, -3=connection lost, -4=connection timeout
+      bool finite = isdigit(value[0]) || (value[0] == '-' && isdigit(value[1])); // Catches "nan", "inf" and "-inf"
+      mqttState.print(finite ? value : "null");
     }
   }
 }
 
+// Helper function to publish the summary values that a tracker calculates, such as sound_level_db_p95, each with its own report-on-change state
+void mqttPublishSummary(const char* topic, const char* format, const MeasurementStats& measurement, MqttReport* reports, bool heartbeat, float absolute, float relative)
+{
+  char summaryTopic[128], value[25];
+  for (int k = 0; k < MEASUREMENT_SUMMARY_VALUES; k++)
+  {
+    if (!(measurement.operators & (1 << k))) continue;
+    snprintf(summaryTopic, sizeof(summaryTopic), "%s%s", topic, measurementSummaryNames[k]);
+    snprintf(value, sizeof(value), format, measurement.summary[k]);
+    mqttPublishValue(summaryTopic, value, false, mqttChanged(reports[k], heartbeat, measurement.summary[k], absolute, relative));
+  }
+}
+
 // Send all data to MQTT
-void updateMQTT()
+void updateMQTT(bool heartbeat)
 {
+  LatencyTimer latency(mqttUpdateLatency);
   char mqttStringBuffer[25];
   struct tm timeInfo; // NTP
 
-  // Helper macro to format and publish a single value to MQTT
-  #define MQTT_PUBLISH(topic, format, value) sprintf(mqttStringBuffer, format, value); mqttClient.publish(topic, mqttStringBuffer, true);
+  // Helper macro to format and publish a single value to MQTT when it moves past its deadband, with report-on-change state for each call site
+  // The deadband is variadic because the deadband macros expand to two arguments
+  #define MQTT_PUBLISH(topic, format, value, ...) { static MqttReport report; sprintf(mqttStringBuffer, format, value); mqttPublishValue(topic, mqttStringBuffer, false, mqttChanged(report, heartbeat, value, __VA_ARGS__)); }
+
+  // Helper macros to expand the published value registries into topics
+  #define MQTT_STATS(name, description, format, measurement, ...) \
+    MQTT_PUBLISH(MQTT_TOPIC_BASE name,            format, (measurement).current, __VA_ARGS__) \
+    MQTT_PUBLISH(MQTT_TOPIC_BASE name "_min",     format, (measurement).min, __VA_ARGS__) \
+    MQTT_PUBLISH(MQTT_TOPIC_BASE name "_average", format, (measurement).average, __VA_ARGS__) \
+    MQTT_PUBLISH(MQTT_TOPIC_BASE name "_max",     format, (measurement).max, __VA_ARGS__) \
+    { static MqttReport reports[MEASUREMENT_SUMMARY_VALUES]; mqttPublishSummary(MQTT_TOPIC_BASE name, format, measurement, reports, heartbeat, __VA_ARGS__); }
+  #define MQTT_VALUE(name, description, format, value, ...) MQTT_PUBLISH(MQTT_TOPIC_BASE name, format, (float)(value), __VA_ARGS__)
+
+  // Start the JSON state document
+  mqttState.clear();
+  mqttState.print("{");
+  mqttStateCount = 0;
+  mqttChangeCount = 0;
 
   // Environmentals
-  xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data
-  if (environmentSensorOK)
-  {
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_temperature",           "%0.1f", environmentTemperature.current);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_temperature_min",       "%0.1f", environmentTemperature.min);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_temperature_average",   "%0.1f", environmentTemperature.average);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_temperature_max",       "%0.1f", environmentTemperature.max);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_dew_point",             "%0.1f", environmentDewPoint.current);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_dew_point_min",         "%0.1f", environmentDewPoint.min);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_dew_point_average",     "%0.1f", environmentDewPoint.average);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_dew_point_max",         "%0.1f", environmentDewPoint.max);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_humidity",              "%0.1f", environmentHumidity.current);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_humidity_min",          "%0.1f", environmentHumidity.min);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_humidity_average",      "%0.1f", environmentHumidity.average);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_humidity_max",          "%0.1f", environmentHumidity.max);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_pressure_mbar",         "%0.1f", environmentPressure.current);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_pressure_mbar_min",     "%0.1f", environmentPressure.min);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_pressure_mbar_average", "%0.1f", environmentPressure.average);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_pressure_mbar_max",     "%0.1f", environmentPressure.max);
+  EnvironmentSnapshot environment = environmentSnapshot.read(); // Consistent copy of the environmental data (published by a different thread)
+  if (environment.ok)
+  {
+    PUBLISH_ENVIRONMENT(MQTT_STATS, MQTT_VALUE)
 
     // IAQ metrics
-    if (environmentIAQAccuracy)
+    if (environment.iaqAccuracy)
     {
-      MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_iaq",              "%0.2f", environmentIAQ.current);
-      MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_iaq_min",          "%0.2f", environmentIAQ.min);
-      MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_iaq_average",      "%0.2f", environmentIAQ.average);
-      MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_iaq_max",          "%0.2f", environmentIAQ.max);
+      PUBLISH_IAQ(MQTT_STATS, MQTT_VALUE)
     }
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_iaq_accuracy", "%d", environmentIAQAccuracy);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_gas_resistance_ohms", "%d", environmentGasResistance);
-    MQTT_PUBLISH(MQTT_TOPIC_BASE "environmental_gas_calibration_accuracy", "%0.1f", environmentGasAccuracy);
+    PUBLISH_GAS(MQTT_STATS, MQTT_VALUE)
   }
-  xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
 
   // Sound level
-  xSemaphoreTake(xMutexSoundSensor, portMAX_DELAY); // Start accessing the sound sensor data (calculated on a different thread)
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "sound_level_db",              "%0.2f", soundSensorSpl.current);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "sound_level_db_min",          "%0.2f", soundSensorSpl.min);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "sound_level_db_average",      "%0.2f", soundSensorSpl.average);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "sound_level_db_max",          "%0.2f", soundSensorSpl.max);
-  xSemaphoreGive(xMutexSoundSensor); // Done with sound sensor data
+  SoundSnapshot sound = soundSnapshot.read(); // Consistent copy of the sound data (published by a different thread)
+  PUBLISH_SOUND(MQTT_STATS, MQTT_VALUE)
 
   // Light level
-  xSemaphoreTake(xMutexLightSensor, portMAX_DELAY); // Start accessing the light sensor data
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "light_level_lux",              "%0.2f", lightSensorLux.current);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "light_level_lux_min",          "%0.2f", lightSensorLux.min);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "light_level_lux_average",      "%0.2f", lightSensorLux.average);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "light_level_lux_max",          "%0.2f", lightSensorLux.max);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "light_level_measurement_gain", "%0.3f", lightSensorGain);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "light_level_measurement_integration_time_ms", "%d", lightSensorIntegrationTime);
-  xSemaphoreGive(xMutexLightSensor); // Done with light sensor data
+  LightSnapshot light = lightSnapshot.read(); // Consistent copy of the light data (published by a different thread)
+  PUBLISH_LIGHT(MQTT_STATS, MQTT_VALUE)
 
   // Measurement window
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "measurement_window_seconds", "%d", MEASUREMENT_WINDOW);
+  MQTT_PUBLISH(MQTT_TOPIC_BASE "measurement_window_seconds", "%d", MEASUREMENT_WINDOW, MQTT_DEADBAND_NONE);
 
   // Uptime information
-  xSemaphoreTake(xMutexUptime, portMAX_DELAY); // Start accessing the uptime data
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "uptime_seconds", "%lld", timer);
-  mqttClient.publish(MQTT_TOPIC_BASE "uptime", uptimeStringBuffer, true);
+  takeMutex(xMutexUptime, mutexWaitUptime); // Start accessing the uptime data
+  MQTT_PUBLISH(MQTT_TOPIC_BASE "uptime_seconds", "%lld", timer, MQTT_DEADBAND_NONE);
+  mqttPublishValue(MQTT_TOPIC_BASE "uptime", uptimeStringBuffer, true, heartbeat);
   xSemaphoreGive(xMutexUptime); // Done with uptime data
 
   // NTP system time
   if (getLocalTime(&timeInfo))
   {
     sprintf(mqttStringBuffer, "%02d/%02d/%d %02d:%02d:%02d", timeInfo.tm_mon + 1, timeInfo.tm_mday, timeInfo.tm_year + 1900, timeInfo.tm_hour, timeInfo.tm_min, timeInfo.tm_sec);
-    mqttClient.publish(MQTT_TOPIC_BASE "esp32_system_time", mqttStringBuffer, true);
+    mqttPublishValue(MQTT_TOPIC_BASE "esp32_system_time", mqttStringBuffer, true, heartbeat);
   }
 
   // WiFi signal strength
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "esp32_wifi_signal_strength_dbm", "%d", WiFi.RSSI());
+  MQTT_PUBLISH(MQTT_TOPIC_BASE "esp32_wifi_signal_strength_dbm", "%d", WiFi.RSSI(), MQTT_DEADBAND_WIFI);
 
   // Free heap memory
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "esp32_free_heap_bytes", "%d", ESP.getFreeHeap());
+  MQTT_PUBLISH(MQTT_TOPIC_BASE "esp32_free_heap_bytes", "%d", ESP.getFreeHeap(), MQTT_DEADBAND_NONE);
 
   // Battery data and AC power on/off state
-  xSemaphoreTake(xMutexBattery, portMAX_DELAY); // Start accessing the battery data
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "esp32_battery_voltage", "%0.2f", batteryVoltage);
-  MQTT_PUBLISH(MQTT_TOPIC_BASE "esp32_battery_percent", "%0.2f", batteryPercent);
-  mqttClient.publish(MQTT_TOPIC_BASE "esp32_ac_power_state", acPowerState ? "1" : "0", true); // 1 for "ON" or 0 for "OFF"
-  xSemaphoreGive(xMutexBattery); // Done with battery data
+  BatterySnapshot battery = batterySnapshot.read(); // Consistent copy of the battery data (published by a different thread)
+  PUBLISH_BATTERY(MQTT_STATS, MQTT_VALUE) // AC power is 1 for "ON" or 0 for "OFF"
 
   // Chip information
-  mqttClient.publish(MQTT_TOPIC_BASE "esp32_chip_information", chipInformation, true);
+  mqttPublishValue(MQTT_TOPIC_BASE "esp32_chip_information", chipInformation, true, heartbeat);
+
+  // Publish the JSON state document as one message, written to the TLS connection in a single call. It always holds every value, and is only published
+  // when something changed or on the heartbeat.
+  mqttState.print("}");
+  mqttState.flush();
+  if (MQTT_PUBLISH_STATE && (heartbeat || mqttChangeCount) && !mqttState.overflowed() && mqttClient.beginPublish(MQTT_TOPIC_BASE "state", mqttState.size(), true))
+  {
+    mqttClient.write((const uint8_t*)mqttState.data(), mqttState.size());
+    mqttClient.endPublish();
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // PSRAM Data Storage
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Allocate PSRAM for long-term data storage
+// Helper function to allocate PSRAM for one data tier
+void setupPsramDataTier(DataHistory& tier, int elements, int streams)
+{
+  size_t size = DataHistory::memoryRequired(elements, streams);
+  if (tier.begin(ps_malloc(size), elements, streams))
+  {
+    Serial.print("PSRAM: Allocated "); Serial.print(size); Serial.println(" bytes");
+  }
+  else
+  {
+    Serial.print("PSRAM: ps_malloc() failed allocating "); Serial.print(size); Serial.println(" bytes from "); Serial.println(ESP.getFreePsram());
+  }
+}
+
+// Allocate PSRAM for long-term data storage and the measurement windows
 void setupPsram()
 {
+  void* trackerMemory = nullptr;
+  size_t trackerSize = MEASUREMENT_PSRAM ? measurementArena.memoryRequired() : 0;
   if (psramFound())
   {
     if (psramInit())
     {
-      psramDataSet = (unsigned char*)ps_malloc(DATA_SET_SIZE + 1); // +1 to make room for the NULL terminator
-      if (psramDataSet)
-      {
-        memset(psramDataSet, ' ', DATA_SET_SIZE); // Fill with spaces
-        psramDataSet[DATA_SET_SIZE] = 0; // NULL terminator
-        Serial.print("PSRAM: Allocated "); Serial.print(DATA_SET_SIZE + 1); Serial.println(" bytes");
-      }
-      else
-      {
-        Serial.print("PSRAM: ps_malloc() failed allocating "); Serial.print(DATA_SET_SIZE + 1); Serial.println(" bytes from "); Serial.println(ESP.getFreePsram());
-      }
+      if (trackerSize) trackerMemory = ps_malloc(trackerSize);
+      setupPsramDataTier(psramDataSet,      DATA_HISTORY_COUNT,       DATA_VALUE_STREAMS);
+      setupPsramDataTier(psramDataSet15m,   DATA_HISTORY_COUNT_15M,   DATA_VALUE_STREAMS * DATA_ROLLUP_STATS);
+      setupPsramDataTier(psramDataSetDaily, DATA_HISTORY_COUNT_DAILY, DATA_VALUE_STREAMS * DATA_ROLLUP_STATS);
+      if (MQTT_QUEUE_COUNT > 0) setupPsramDataTier(mqttQueue, MQTT_QUEUE_COUNT, MQTT_QUEUE_STREAMS);
     }
     else
     {
@@ -585,75 +1492,179 @@ void setupPsram()
   {
     Serial.println("PSRAM: Not found");
   }
+
+  // Hand out the measurement windows, which come from the internal heap if the PSRAM block wasn't allocated
+  measurementArena.begin(trackerMemory, trackerSize);
+  Serial.print("PSRAM: Measurement windows use "); Serial.print(measurementArena.bytesUsed()); Serial.println(" bytes");
 }
 
-// Overloaded helper function to format a data value and put it at the end of the specified data stream (overwriting the end value/slot)
-void addDataElement(int stream, float value)
+// Fill a data sample with the current sensor values, one value per stream in stream order
+void readDataSample(float* sample)
 {
-  char dataFormatBuffer[DATA_ELEMENT_SIZE + 1]; // +1 for NULL terminator
-  memset(dataFormatBuffer, ' ', DATA_ELEMENT_SIZE);   // Fill with spaces
-  int n = sprintf(dataFormatBuffer, "%0.2f,", value); // Format the value with delimiter and NULL terminator
-  if (n > 0) dataFormatBuffer[n] = ' ';               // Remove sprintf() NULL terminator
-  int dataSetIndex = stream * DATA_STREAM_SIZE + DATA_STREAM_SIZE - DATA_ELEMENT_SIZE; // Byte index of the last element in the specified data stream
-  memcpy(psramDataSet + dataSetIndex, dataFormatBuffer, DATA_ELEMENT_SIZE); // Copy the new value (with delimiter) into the data set
+  EnvironmentSnapshot environment = environmentSnapshot.read(); // Consistent copy of the environmental data (published by a different thread)
+  SoundSnapshot sound = soundSnapshot.read(); // Consistent copy of the sound data (published by a different thread)
+  LightSnapshot light = lightSnapshot.read(); // Consistent copy of the light data (published by a different thread)
+  bool iaqReady = environment.iaqAccuracy > 0 && !(environment.gasCalibrationStage <= 1 && environment.iaq.current == 50.0F); // Missing values are used while the IAQ data is initializing
+
+  #define DATA_STREAM_READ(id, name, value, resolution, factor, tracker) sample[DATA_STREAM_##id] = value;
+  DATA_STREAMS(DATA_STREAM_READ)
 }
-void addDataElement(int stream, uint64_t value)
+
+// Add current sensor values to the end of each data stream
+void updateDataSet()
 {
-  char dataFormatBuffer[DATA_ELEMENT_SIZE + 1]; // +1 for NULL terminator
-  memset(dataFormatBuffer, ' ', DATA_ELEMENT_SIZE);   // Fill with spaces
-  int n = sprintf(dataFormatBuffer, "%lld,", value);  // Format the value with delimiter and NULL terminator
-  if (n > 0) dataFormatBuffer[n] = ' ';               // Remove sprintf() NULL terminator
-  int dataSetIndex = stream * DATA_STREAM_SIZE + DATA_STREAM_SIZE - DATA_ELEMENT_SIZE; // Byte index of the last element in the specified data stream
-  memcpy(psramDataSet + dataSetIndex, dataFormatBuffer, DATA_ELEMENT_SIZE); // Copy the new value (with delimiter) into the data set
+  if (psramDataSet.ready())
+  {
+    float sample[DATA_VALUE_STREAMS]; // One value per stream, in stream order
+    readDataSample(sample);
+
+    takeMutex(xMutexDataSet, mutexWaitDataSet); // Start accessing the data tiers (read by the web server task)
+    psramDataSet.append((int32_t)timer, sample); // Time index
+
+    // Long-term rollups
+    dataRollup15m.add((int32_t)timer, sample, psramDataSet15m);
+    dataRollupDaily.add((int32_t)timer, sample, psramDataSetDaily);
+    xSemaphoreGive(xMutexDataSet); // Done with the data tiers
+
+    // Flash log, once the clock has been set
+    time_t now = time(NULL);
+    if (dataLogReady && now >= DATA_LOG_VALID_EPOCH)
+    {
+      dataLog.append((uint32_t)now, sample);
+    }
+  }
 }
-void addNullDataElement(int stream)
+
+// Queue one sample while the broker can't be reached. When the queue is full, the oldest sample is overwritten.
+void queueMQTTSample()
 {
-  char dataFormatBuffer[DATA_ELEMENT_SIZE + 1]; // +1 for NULL terminator
-  memset(dataFormatBuffer, ' ', DATA_ELEMENT_SIZE);   // Fill with spaces
-  int n = sprintf(dataFormatBuffer, "%s,", "null");   // Format the JavaScript NULL value with delimiter and NULL terminator
-  if (n > 0) dataFormatBuffer[n] = ' ';               // Remove sprintf() NULL terminator
-  int dataSetIndex = stream * DATA_STREAM_SIZE + DATA_STREAM_SIZE - DATA_ELEMENT_SIZE; // Byte index of the last element in the specified data stream
-  memcpy(psramDataSet + dataSetIndex, dataFormatBuffer, DATA_ELEMENT_SIZE); // Copy the new value (with delimiter) into the data set
+  if (!mqttQueue.ready()) return;
+  float sample[MQTT_QUEUE_STREAMS];
+  readDataSample(sample);
+  BatterySnapshot battery = batterySnapshot.read(); // Consistent copy of the battery data (published by a different thread)
+  sample[DATA_VALUE_STREAMS + 0] = battery.voltage;
+  sample[DATA_VALUE_STREAMS + 1] = battery.percent;
+  sample[DATA_VALUE_STREAMS + 2] = battery.acPowerState;
+
+  if (mqttQueue.size() == mqttQueue.maxSize() && mqttQueue.indexOf(mqttQueueNext) == 0)
+  {
+    mqttQueueNext++; // The oldest unsent sample is about to be overwritten
+    mqttQueueDropped++;
+  }
+  mqttQueue.append((int32_t)timer, sample);
+  mqttQueuePending = mqttQueue.firstSequence() + mqttQueue.size() - mqttQueueNext;
 }
 
-// Add current sensor values to the end of each data stream
-void updateDataSet()
+// Send the next batch of queued samples to MQTT_TOPIC_BASE "history" as {"samples":[{"time":<epoch seconds>,"<name>":<value>,...},...]}, oldest first.
+// One batch is sent every MQTT_QUEUE_INTERVAL seconds so the queue doesn't crowd out live updates. Samples are stamped with the clock time, so the
+// queue waits until NTP has set the clock.
+void sendMQTTQueue()
 {
-  if (psramDataSet)
+  if (!mqttQueuePending || !mqttClient.connected() || millis() - mqttQueueLastBatch < MQTT_QUEUE_INTERVAL * 1000UL) return;
+  time_t now = time(NULL);
+  if (now < DATA_LOG_VALID_EPOCH) return;
+  int64_t epochOffset = (int64_t)now - (int64_t)timer; // Converts time indexes to clock times
+  mqttQueueLastBatch = millis();
+
+  int first = mqttQueue.indexOf(mqttQueueNext);
+  int n = mqttQueue.size() - first < MQTT_QUEUE_BATCH ? mqttQueue.size() - first : MQTT_QUEUE_BATCH;
+  mqttQueueBatch.clear();
+  mqttQueueBatch.print("{\"samples\":[");
+  for (int i = first; i < first + n; i++)
   {
-    // Shift all data streams down by one element. The updates below will overwrite the last element in each stream.
-    memmove(psramDataSet, psramDataSet + DATA_ELEMENT_SIZE, DATA_SET_SIZE - DATA_ELEMENT_SIZE);
-
-    xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data
-    addDataElement(0, environmentTemperature.current);
-    addDataElement(1, environmentHumidity.current);
-    addDataElement(2, environmentDewPoint.current);
-    addDataElement(3, environmentPressure.current);
-    if (environmentIAQAccuracy > 0 && !(environmentGasCalibrationStage <= 1 && environmentIAQ.current == 50.0F))
+    mqttQueueBatch.printf(i > first ? ",{\"time\":%lld" : "{\"time\":%lld", (long long)(mqttQueue.time(i) + epochOffset));
+    for (int s = 0; s < MQTT_QUEUE_STREAMS; s++)
     {
-      addDataElement(4, environmentIAQ.current);
-      addDataElement(5, (float)environmentGasResistance / 1000.0F); // Convert to kiloohms to fit within the PSRAM data slot with fewer digits
-      addDataElement(6, environmentGasAccuracy);
+      float v = mqttQueue.value(s, i);
+      if (isfinite(v)) mqttQueueBatch.printf(",\"%s\":%0.2f", mqttQueueNames[s], v * mqttQueueFactors[s]); // Missing values are left out
     }
-    else
+    mqttQueueBatch.print("}");
+  }
+  mqttQueueBatch.print("]}");
+  mqttQueueBatch.flush();
+  if (!mqttQueueBatch.overflowed() && mqttClient.beginPublish(MQTT_TOPIC_BASE "history", mqttQueueBatch.size(), false)) // A truncated batch isn't valid JSON
+  {
+    mqttClient.write((const uint8_t*)mqttQueueBatch.data(), mqttQueueBatch.size());
+    if (mqttClient.endPublish())
     {
-      // Use JavaScript NULL values if the IAQ data is not ready yet (due to initialization)
-      addNullDataElement(4);
-      addNullDataElement(5);
-      addNullDataElement(6);
+      mqttQueueNext += n;
+      mqttQueuePending -= n;
     }
-    xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
+  }
+}
 
-    xSemaphoreTake(xMutexSoundSensor, portMAX_DELAY); // Start accessing the sound sensor data
-    addDataElement(7, soundSensorSpl.current);
-    xSemaphoreGive(xMutexSoundSensor); // Done with sound sensor data
+// Track a restored value, ignoring missing values and streams without a tracker. Each data element stands for UPDATE_INTERVAL_DATA seconds, so it's
+// tracked once for each reading the tracker would have taken in that time, which keeps the window length and the weights of the values right.
+inline void restoreMeasurement(MeasurementTracker* tracker, float value)
+{
+  if (!tracker || !isfinite(value)) return;
+  int repeats = (int)((int64_t)tracker->size() * UPDATE_INTERVAL_DATA / MEASUREMENT_WINDOW);
+  tracker->track(value, repeats > 1 ? repeats : 1);
+}
 
-    xSemaphoreTake(xMutexLightSensor, portMAX_DELAY); // Start accessing the light sensor data
-    addDataElement(8, lightSensorLux.current);
-    xSemaphoreGive(xMutexLightSensor); // Done with light sensor data
+// Add one data element from the flash log to the data tiers, and to the measurement trackers if it's within the measurement window
+void restoreDataSample(uint32_t epoch, const float* sample)
+{
+  static int32_t last = INT32_MIN;
+  int32_t index = (int32_t)((int64_t)epoch - dataLogBootEpoch); // Time index in seconds of uptime, which is negative before this boot
+  if (index > 0 || index <= last) return; // Skip elements that are out of order, such as from before a clock correction
+  last = index;
+
+  psramDataSet.append(index, sample);
+  dataRollup15m.add(index, sample, psramDataSet15m);
+  dataRollupDaily.add(index, sample, psramDataSetDaily);
+  if (index > -MEASUREMENT_WINDOW)
+  {
+    #define DATA_STREAM_RESTORE(id, name, value, resolution, factor, tracker) restoreMeasurement(tracker, sample[DATA_STREAM_##id]);
+    DATA_STREAMS(DATA_STREAM_RESTORE)
+  }
+}
+
+// Seconds east of UTC in the NTP_TIMEZONE at the specified clock time, including daylight saving time
+int32_t utcOffsetSeconds(time_t t)
+{
+  struct tm local, utc;
+  localtime_r(&t, &local);
+  gmtime_r(&t, &utc);
+  int days = local.tm_yday - utc.tm_yday;
+  if (days > 1) days = -1; else if (days < -1) days = 1; // Across the end of a year
+  return days * 86400 + (local.tm_hour - utc.tm_hour) * 3600 + (local.tm_min - utc.tm_min) * 60;
+}
+
+// Mount the flash file system, open the data log, and restore the data history from it. This runs before the other tasks are started, so the data tiers
+// and trackers don't need to be locked.
+void setupDataLog()
+{
+  if (!DATA_LOG_ENABLE || !psramDataSet.ready()) return;
+  if (!LittleFS.begin(true)) // Format the partition if it can't be mounted
+  {
+    Serial.println("DataLog: LittleFS mount failed");
+    return;
+  }
+  if (!dataLog.begin(LittleFS, "/history0.bin", "/history1.bin"))
+  {
+    Serial.println("DataLog: Failed to open the log");
+    return;
+  }
+  dataLogReady = true;
 
-    addDataElement(9, timer); // Time index
+  // The log is stamped with the clock time, so the time is needed to place the restored elements
+  unsigned long start = millis();
+  while (time(NULL) < DATA_LOG_VALID_EPOCH && millis() - start < DATA_LOG_SYNC_TIMEOUT) delay(100);
+  if (time(NULL) < DATA_LOG_VALID_EPOCH)
+  {
+    Serial.println("DataLog: Clock not set by NTP, so the history was not restored");
+    return;
   }
+  start = millis();
+  dataLogBootEpoch = (int64_t)time(NULL) - systemSeconds();
+
+  // Line the rollup periods up with the local clock, so the daily elements run from midnight to midnight
+  int64_t localBoot = dataLogBootEpoch + utcOffsetSeconds(time(NULL));
+  dataRollup15m.align(localBoot);
+  dataRollupDaily.align(localBoot);
+  int count = dataLog.restore(DATA_HISTORY_COUNT, restoreDataSample);
+  Serial.printf("DataLog: Restored %d elements in %lu ms", count, millis() - start); Serial.println();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -710,79 +1721,82 @@ void formatLux(char* buffer, float lux)
   }
 }
 
-// Update the TFT display
-void updateDisplay()
+// Draw one line of text on the display, but only if it changed since it was last drawn
+void displayLine(int line, uint16_t color, const char* text)
 {
-  char formatBuffer[40];
-  int64_t seconds = systemSeconds(); // Current system clock in seconds, used to flip/flop display data
+  if (strcmp(displayLines[line], text) == 0) return;
+  strlcpy(displayLines[line], text, sizeof(displayLines[line]));
 
   canvas.fillScreen(ST77XX_BLACK);
-  canvas.setFont(&FreeSans9pt7b);
-  canvas.setCursor(0, 20);
+  canvas.setTextColor(color);
+  canvas.setCursor(0, TFT_BASELINE);
+  canvas.print(text);
+
+  int y = line * TFT_LINE_HEIGHT;
+  if (TFT_ROTATION == 2) y = TFT_SCREEN_HEIGHT - y - TFT_LINE_HEIGHT; // The canvas is rotated 180 degrees, so the lines are in reverse order on the display
+  display.drawRGBBitmap(0, y, canvas.getBuffer(), TFT_SCREEN_WIDTH, TFT_LINE_HEIGHT);
+}
 
-  xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data (calculated on a different thread)
-  canvas.setTextColor(ST77XX_GREEN);
+// Update the TFT display. Nothing is drawn while the backlight is off, because the display isn't visible.
+void updateDisplay()
+{
+  if (!displayOn) return;
+  char text[48], formatBuffer[3][12];
+  int64_t seconds = systemSeconds(); // Current system clock in seconds, used to flip/flop display data
+
+  EnvironmentSnapshot environment = environmentSnapshot.read(); // Consistent copy of the environmental data (published by a different thread)
   if (seconds % 2)
   {
     #if defined(BME680_TEMP_F)
-      canvas.printf("Dew: %0.1fF   IAQ %0.1f%%", environmentDewPoint.current, environmentIAQ.current);
+      snprintf(text, sizeof(text), "Dew: %0.1fF   IAQ %0.1f%%", environment.dewPoint.current, environment.iaq.current);
     #else
-      canvas.printf("Dew: %0.1fC   IAQ %0.1f%%", environmentDewPoint.current, environmentIAQ.current);
+      snprintf(text, sizeof(text), "Dew: %0.1fC   IAQ %0.1f%%", environment.dewPoint.current, environment.iaq.current);
     #endif
   }
   else
   {
     #if defined(BME680_TEMP_F)
-      canvas.printf("%0.1fF   %0.1f%%   %0.0f mbar", environmentTemperature.current, environmentHumidity.current, environmentPressure.current);
+      snprintf(text, sizeof(text), "%0.1fF   %0.1f%%   %0.0f mbar", environment.temperature.current, environment.humidity.current, environment.pressure.current);
     #else
-      canvas.printf("%0.1fC   %0.1f%%   %0.0f mbar", environmentTemperature.current, environmentHumidity.current, environmentPressure.current);
+      snprintf(text, sizeof(text), "%0.1fC   %0.1f%%   %0.0f mbar", environment.temperature.current, environment.humidity.current, environment.pressure.current);
     #endif
   }
-  canvas.println();
-  xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
+  displayLine(0, ST77XX_GREEN, text);
 
-  xSemaphoreTake(xMutexSoundSensor, portMAX_DELAY); // Start accessing sound data (measured on a different thread)
-  canvas.setTextColor(ST77XX_WHITE);
-  canvas.printf("%0.2f    %0.2f    %0.2f dB", soundSensorSpl.current, soundSensorSpl.average, soundSensorSpl.max);
-  canvas.println();
-  xSemaphoreGive(xMutexSoundSensor); // Done with sound data
+  SoundSnapshot sound = soundSnapshot.read(); // Consistent copy of the sound data (published by a different thread)
+  snprintf(text, sizeof(text), "%0.2f    %0.2f    %0.2f dB", sound.spl.current, sound.spl.average, sound.spl.max);
+  displayLine(1, ST77XX_WHITE, text);
 
-  xSemaphoreTake(xMutexLightSensor, portMAX_DELAY); // Start accessing light data (measured on a different thread)
-  canvas.setTextColor(ST77XX_YELLOW);
-  formatLux(formatBuffer, lightSensorLux.current); canvas.print(formatBuffer); canvas.print("  ");
-  formatLux(formatBuffer, lightSensorLux.average); canvas.print(formatBuffer); canvas.print("  ");
-  formatLux(formatBuffer, lightSensorLux.max);     canvas.print(formatBuffer); canvas.print(" lux");
-  canvas.println();
-  xSemaphoreGive(xMutexLightSensor); // Done with light data
+  LightSnapshot light = lightSnapshot.read(); // Consistent copy of the light data (published by a different thread)
+  formatLux(formatBuffer[0], light.lux.current);
+  formatLux(formatBuffer[1], light.lux.average);
+  formatLux(formatBuffer[2], light.lux.max);
+  snprintf(text, sizeof(text), "%s  %s  %s lux", formatBuffer[0], formatBuffer[1], formatBuffer[2]);
+  displayLine(2, ST77XX_YELLOW, text);
 
-  canvas.setTextColor(ST77XX_MAGENTA);
   if (seconds % 2)
   {
-    xSemaphoreTake(xMutexBattery, portMAX_DELAY); // Start accessing the battery data (calculated on a different thread)
-    canvas.printf("Battery: %0.2fV / %0.0f%%", batteryVoltage, batteryPercent);
-    xSemaphoreGive(xMutexBattery); // Done with battery data
+    BatterySnapshot battery = batterySnapshot.read(); // Consistent copy of the battery data (published by a different thread)
+    snprintf(text, sizeof(text), "Battery: %0.2fV / %0.0f%%", battery.voltage, battery.percent);
   }
   else
   {
-    xSemaphoreTake(xMutexUptime, portMAX_DELAY); // Start accessing the uptime data (calculated on a different thread)
-    canvas.printf("Uptime: %s", uptimeStringBuffer);
+    takeMutex(xMutexUptime, mutexWaitUptime); // Start accessing the uptime data (calculated on a different thread)
+    snprintf(text, sizeof(text), "Uptime: %s", uptimeStringBuffer);
     xSemaphoreGive(xMutexUptime); // Done with uptime data
   }
-  canvas.println();
+  displayLine(3, ST77XX_MAGENTA, text);
 
-  canvas.setTextColor(ST77XX_CYAN);
   if (seconds % 2)
   {
-    canvas.printf("WiFi Signal: %d dBm", WiFi.RSSI());
+    snprintf(text, sizeof(text), "WiFi Signal: %d dBm", WiFi.RSSI());
   }
   else
   {
     IPAddress ip = WiFi.localIP();
-    canvas.printf("IP Address: %d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
+    snprintf(text, sizeof(text), "IP Address: %d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
   }
-  //canvas.println();
-
-  display.drawRGBBitmap(0, 0, canvas.getBuffer(), TFT_SCREEN_WIDTH, TFT_SCREEN_HEIGHT);
+  displayLine(4, ST77XX_CYAN, text);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -830,14 +1844,11 @@ void measureEnvironmentals()
     {
       // Reset the BME680
       Serial.println("Environmentals: NaN detected - Resetting BME680");
-      xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data
       setupEnvironmentalSensor();
-      xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
     }
     else
     {
       // Update the environmental values
-      xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data
       environmentTemperature.track(BME680_TEMP_F ? t * 9.0F / 5.0F + 32.0F : t);
       environmentHumidity.track(h);
       environmentPressure.track(p);
@@ -850,23 +1861,33 @@ void measureEnvironmentals()
 
       // Sensor is operational
       environmentSensorOK = true;
-      xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
     }
   }
   else
   {
     // Reset the BME680
     Serial.printf("Environmentals: BME680 data error: t=%0.1f h=%0.1f p=%0.1f", t, h, p); Serial.println();
-    xSemaphoreTake(xMutexEnvironmental, portMAX_DELAY); // Start accessing the environmental data
     setupEnvironmentalSensor();
-    xSemaphoreGive(xMutexEnvironmental); // Done with environmental data
   }
+
+  // Publish the environmental values for the other tasks
+  environmentSnapshot.write({ environmentSensorOK, environmentTemperature.stats(), environmentDewPoint.stats(), environmentHumidity.stats(), environmentPressure.stats(), environmentIAQ.stats(),
+                              environmentIAQAccuracy, environmentGasResistance, environmentGasAccuracy, environmentGasCalibrationStage });
+  metricsDirty[METRICS_ENVIRONMENT] = true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // VEML7700 Light Sensor
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Switch the VEML7700 to the specified step of the auto-range ladder. The new settings apply from the next integration period.
+void setLightSensorRange(int range)
+{
+  lightSensorRange = range;
+  lightSensor.setGain(lightSensorRanges[range].gain);
+  lightSensor.setIntegrationTime(lightSensorRanges[range].integrationTime, false); // Don't wait for an integration period
+}
+
 // Setup the VEML7700 light sensor
 void setupLightSensor()
 {
@@ -878,46 +1899,54 @@ void setupLightSensor()
     Serial.println("Light: Configuration failed");
     //while (1); // Halt execution
   }
-  //lightSensor.setIntegrationTime(VEML7700_IT_100MS); // Set integration time to 100ms
-  //lightSensor.setGain(VEML7700_GAIN_1X); // Set gain to 1x
-  //lightSensor.setPower(VEML7700_POWER_ON); // Power on the sensor
+  setLightSensorRange(lightSensorRange);
 }
 
-// Light level measurement using the VEML7700 sensor
-// Reference: https://github.com/adafruit/Adafruit_VEML7700/blob/master/examples/veml7700_autolux/veml7700_autolux.ino
-void measureLight()
+// Start a light level reading. The VEML7700 integrates continuously, so this just returns the number of milliseconds until a complete integration
+// period has passed at the current range. Right after a range change, the period in progress may have started with the old settings, so wait for two.
+unsigned long startLight()
 {
-  // Read lux using the automatic method which adjusts gain and integration time as needed to obtain a good reading. A non-linear correction is also applied if needed.
-  float lux = lightSensor.readLux(VEML_LUX_AUTO);
-  uint8_t sensorGain = lightSensor.getGain();
-  uint8_t sensorIntegrationTime = lightSensor.getIntegrationTime();
+  static int lastRange = -1;
+  int periods = lightSensorRange == lastRange ? 1 : 2;
+  lastRange = lightSensorRange;
+  return periods * lightSensorRanges[lightSensorRange].integrationMillis + 10; // Plus a little margin for the sensor's internal timing
+}
 
-  // Translate the gain and integration time values
-  float gain; 
-  switch (sensorGain)
+// Light level measurement using the VEML7700 sensor. Returns false if the range was changed and the reading needs to be taken again.
+// Reference: https://github.com/adafruit/Adafruit_VEML7700/blob/master/examples/veml7700_autolux/veml7700_autolux.ino
+bool measureLight()
+{
+  // Read the raw count at the current range. If it's saturated or too coarse, step one notch along the ladder and read again after the next
+  // integration period. Since the range is kept between readings, a reading usually finishes in one integration period.
+  uint16_t als = lightSensor.readALS();
+  if (als > VEML7700_ALS_HIGH && lightSensorRange > 0)
   {
-    case VEML7700_GAIN_2:   gain = 2;     break;
-    case VEML7700_GAIN_1:   gain = 1;     break;
-    case VEML7700_GAIN_1_4: gain = 0.25;  break;
-    case VEML7700_GAIN_1_8: gain = 0.125; break;
+    setLightSensorRange(lightSensorRange - 1);
+    return false;
   }
-  int integrationTime;
-  switch (sensorIntegrationTime)
+  if (als < VEML7700_ALS_LOW && lightSensorRange < VEML7700_RANGES - 1)
+  {
+    setLightSensorRange(lightSensorRange + 1);
+    return false;
+  }
+
+  // Calculate lux from the raw count and range, with the same non-linear correction as the Adafruit library for bright light
+  const LightSensorRange& range = lightSensorRanges[lightSensorRange];
+  float resolution = VEML7700_MAX_RESOLUTION * (800.0F / range.integrationMillis) * (2.0F / range.gainFactor);
+  float lux = als * resolution;
+  if (lux > 1000)
   {
-    case VEML7700_IT_25MS:  integrationTime = 25;  break;
-    case VEML7700_IT_50MS:  integrationTime = 50;  break;
-    case VEML7700_IT_100MS: integrationTime = 100; break;
-    case VEML7700_IT_200MS: integrationTime = 200; break;
-    case VEML7700_IT_400MS: integrationTime = 400; break;
-    case VEML7700_IT_800MS: integrationTime = 800; break;
+    lux = (((6.0135e-13F * lux - 9.3924e-9F) * lux + 8.1488e-5F) * lux + 1.0023F) * lux;
   }
+  float gain = range.gainFactor;
+  int integrationTime = range.integrationMillis;
 
   // Update light sensor data values
-  xSemaphoreTake(xMutexLightSensor, portMAX_DELAY); // Start accessing the light sensor data
   lightSensorLux.track(lux);
   lightSensorGain = gain;
   lightSensorIntegrationTime = integrationTime;
-  xSemaphoreGive(xMutexLightSensor); // Done with light sensor data
+  lightSnapshot.write({ lightSensorLux.stats(), lightSensorGain, lightSensorIntegrationTime }); // Publish for the other tasks
+  metricsDirty[METRICS_LIGHT] = true;
 
   // Detect sensor failure
   /*
@@ -928,6 +1957,7 @@ void measureLight()
     ESP.restart(); // Soft system reset
   }
   */
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -947,6 +1977,17 @@ void setupBatteryMonitor()
   }
 }
 
+// Switch between full power and power save operation. In power save mode, the CPU clock is lowered, WiFi uses max modem sleep, sound is measured
+// on a duty cycle, the light sensor and battery monitor are read less often, and MQTT values are only published on a longer heartbeat. Called from
+// loop(), which owns the WiFi and network work, rather than from the I2C task that reads the AC power state.
+void setPowerSaveMode(bool enable)
+{
+  Serial.println(enable ? "Power: AC power lost, switching to power save mode" : "Power: AC power restored, switching to full power mode");
+  powerSaveMode = enable;
+  setCpuFrequencyMhz(enable ? POWER_SAVE_CPU_MHZ : cpuFrequencyFull);
+  WiFi.setSleep(enable ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+}
+
 // Read the battery voltage using the MAX17048 LiPo battery monitor, and ALSO read the AC power on/off state from a digital input pin
 void measureBattery()
 {
@@ -954,57 +1995,94 @@ void measureBattery()
   float v = max17048.cellVoltage();
   float p = max17048.cellPercent();
 
-  // Update the battery and AC power data values
-  xSemaphoreTake(xMutexBattery, portMAX_DELAY); // Start accessing the battery data
-  if (batteryVoltage == 0)
-  {
-    // Initialize values
-    batteryVoltage = v;
-    batteryPercent = p;
-  }
-  else
-  {
-    // EMA moving average to smooth the readings
-    batteryVoltage = (batteryVoltage * (MEASUREMENT_WINDOW - 1) + v) / MEASUREMENT_WINDOW;
-    batteryPercent = (batteryPercent * (MEASUREMENT_WINDOW - 1) + p) / MEASUREMENT_WINDOW;
-  }
+  // Update the battery and AC power data values, with an EMA moving average to smooth the readings
+  batteryVoltage = batteryVoltageAverage.add(v);
+  batteryPercent = batteryPercentAverage.add(p);
+  batteryChargeRate = max17048.chargeRate();
   acPowerState = digitalRead(AC_POWER_PIN); // Read the AC power on/off state from a digital input pin
-  xSemaphoreGive(xMutexBattery); // Done with battery data
+
+  // Request power save mode while the AC power is lost, and full power mode when it returns. loop() makes the switch.
+  bool powerSaveRequested = POWER_SAVE_ENABLE && acPowerState == 0;
+
+  batterySnapshot.write({ batteryVoltage, batteryPercent, acPowerState, batteryChargeRate, powerSaveRequested }); // Publish for the other tasks
+  metricsDirty[METRICS_BATTERY] = true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Read I2C devices in sequence (background task)
+// Cooperative I2C scheduler (background task)
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Each device is read in sequence so that a single task can be used to read all I2C data without a semaphore, and so the timing can be well controlled
-void readI2CDevices(void *parameter)
+// Start a BME680 reading, which takes about 370ms to convert, and return the number of milliseconds until it's done. If a reading is already
+// converting, this just returns the time that's left, so the scheduler can come back to it without starting over.
+unsigned long startEnvironmentals()
 {
-  unsigned long timer;
+  if (!environmentReadingEnd) environmentReadingEnd = bme680.beginReading();
+  if (!environmentReadingEnd) return 0; // Couldn't start, so the finish step skips this reading
+  long remaining = (long)(environmentReadingEnd - millis());
+  return remaining > 0 ? remaining : 0;
+}
 
+// Finish the BME680 reading. Returns false until the conversion is done, so the other devices are read in the meantime instead of blocking.
+bool finishEnvironmentals()
+{
+  if (!environmentReadingEnd) return true; // The reading couldn't be started
+  if ((long)(millis() - environmentReadingEnd) < 0) return false; // Still converting
+  environmentReadingEnd = 0;
+  if (bme680.endReading()) // Returns right away since the conversion is done
+  {
+    measureEnvironmentals(); // Read the BME680 environmentals
+  }
+  return true;
+}
+
+// MAX17048 readings take about 5ms
+bool finishBattery()
+{
+  measureBattery();
+  return true;
+}
+
+I2CDevice i2cDevices[I2C_DEVICES] = {
+  { "bme680",   I2C_INTERVAL_ENVIRONMENT, false, startEnvironmentals, finishEnvironmentals }, // Keeps its interval in power save mode for the IAQ algorithm
+  { "veml7700", I2C_INTERVAL_LIGHT,       true,  startLight,          measureLight         },
+  { "max17048", I2C_INTERVAL_BATTERY,     true,  NULL,                finishBattery        }
+};
+
+// Run the I2C device readings as they come due
+void readI2CDevices(void *parameter)
+{
   // Infinite loop since this is a separate task from the main thread
-  //unsigned long interval;
   while (true)
   {
-    if (millis() - timer >= I2C_INTERVAL)
+    taskLoadI2C.begin();
+    for (I2CDevice& device : i2cDevices)
     {
-      timer = millis(); // Reset the timer
-      //interval = millis();
-      if (bme680.performReading()) // Takes about 370ms
+      unsigned long now = millis();
+      if ((long)(now - device.due) < 0) continue; // Not due yet
+
+      // Start a new reading
+      if (!device.busy)
+      {
+        device.busy = true;
+        device.started = now;
+        device.due = now + (device.start ? device.start() : 0);
+        if ((long)(millis() - device.due) < 0) continue; // Come back when the sensor is ready
+      }
+
+      // Finish the reading, and schedule the next one. A reading that runs late is started right away rather than trying to catch up.
+      int64_t finishStart = INSTRUMENTATION_MICROS();
+      bool finished = device.finish();
+      device.latency.record(INSTRUMENTATION_MICROS() - finishStart);
+      if (!finished)
       {
-        measureEnvironmentals(); // Read the BME680 environmentals
+        device.due = millis() + (device.start ? device.start() : 0); // Start over (or wait longer), but keep the original start time for the schedule
+        continue;
       }
-      //interval = millis() - interval;
-      //Serial.print("BME680 interval = "); Serial.println(interval);
-      //interval = millis();
-      measureLight();   // Measure the light level, takes up to 5118ms whne dark due to auto gain
-      //interval = millis() - interval;
-      //Serial.print("VEML7700 interval = "); Serial.println(interval);
-      //interval = millis();
-      measureBattery(); // Read the LiPo battery voltage, takes about 5ms
-      //interval = millis() - interval;
-      //Serial.print("Battery interval = "); Serial.println(interval);
+      device.busy = false;
+      device.due = device.started + device.interval * (powerSaveMode && device.powerSaveSlow ? POWER_SAVE_I2C_FACTOR : 1);
     }
-    delay(25); // Non-blocking delay on ESP32, in milliseconds
+    taskLoadI2C.end();
+    delay(I2C_SCHEDULER_TICK); // Non-blocking delay on ESP32, in milliseconds
   }
 }
 
@@ -1012,103 +2090,248 @@ void readI2CDevices(void *parameter)
 // SPH0645 I2S Sound Sensor
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// I2S receive callback, which runs in the ISR each time a DMA buffer is filled. The buffer is passed to the sound task without copying it. It stays valid
+// until the DMA wraps back around to it, I2S_DMA_BUF_COUNT - 1 buffers later, which leaves the sound task several buffer periods to process it. The
+// queue only holds that many buffers, so when it's full, the oldest buffer is the one the DMA is now overwriting. It's dropped and counted as an overrun.
+bool IRAM_ATTR soundSensorReceive(i2s_chan_handle_t handle, i2s_event_data_t* event, void* context)
+{
+  #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    SoundBuffer buffer = { (const int32_t*)event->dma_buf, event->size, soundSensorSequence++ };
+  #else
+    SoundBuffer buffer = { *(const int32_t**)event->data, event->size, soundSensorSequence++ }; // Older versions pass a pointer to the buffer pointer
+  #endif
+  BaseType_t woken = pdFALSE;
+  if (xQueueSendFromISR(soundSensorBuffers, &buffer, &woken) != pdTRUE)
+  {
+    SoundBuffer stale;
+    xQueueReceiveFromISR(soundSensorBuffers, &stale, &woken);
+    xQueueSendFromISR(soundSensorBuffers, &buffer, &woken);
+    soundSensorOverruns++;
+  }
+  return woken == pdTRUE; // Yield to the sound task right away if it's waiting
+}
+
+// True when the DMA has wrapped back around to a queued buffer, so its samples are being (or have been) overwritten
+bool soundBufferStale(const SoundBuffer& buffer)
+{
+  return soundSensorSequence - buffer.sequence >= I2S_DMA_BUF_COUNT;
+}
+
 // Setup the SPH0645 I2S sound sensor
 void setupSoundSensor()
 {
   Serial.println("Sound: Configuring SPH0645");
 
-  // Configure I2S
-  i2s_config_t i2s_config = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX), // Master mode, Receive data
-    .sample_rate = I2S_SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE,
-    .channel_format = I2S_NUM_CHANNELS,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S, // Standard I2S protocol
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,          // Interrupt priority
-    .dma_buf_count = I2S_DMA_BUF_COUNT,
-    .dma_buf_len = I2S_DMA_BUF_LEN,
-    .use_apll = true, // Use internal APLL clock source (false usually works for lower sample rates)
-    .tx_desc_auto_clear = false, // Not used in RX mode
-    .fixed_mclk = 0             // MCLK not used
-  };
-
-  // Configure I2S Pins
-  i2s_pin_config_t pin_config = {
-    .bck_io_num = I2S_BCLK_PIN,
-    .ws_io_num = I2S_LRCK_PIN,
-    .data_out_num = I2S_PIN_NO_CHANGE, // Not transmitting data
-    .data_in_num = I2S_DATA_IN_PIN
-  };
+  // Create the queue first, so the sound task just waits (and the rest of the sensor keeps running) if the I2S channel can't be set up
+  soundSensorBuffers = xQueueCreate(I2S_DMA_BUF_COUNT - 1, sizeof(SoundBuffer)); // The buffers that are still valid, not counting the one being filled
 
-  // Install and start the I2S driver
-  esp_err_t err = i2s_driver_install(I2S_PORT_NUM, &i2s_config, 0, NULL);
+  // Create the I2S receive channel
+  i2s_chan_config_t channelConfig = I2S_CHANNEL_DEFAULT_CONFIG(I2S_PORT_NUM, I2S_ROLE_MASTER);
+  channelConfig.dma_desc_num = I2S_DMA_BUF_COUNT;
+  channelConfig.dma_frame_num = I2S_DMA_BUF_LEN;
+  esp_err_t err = i2s_new_channel(&channelConfig, NULL, &soundSensorChannel);
   if (err != ESP_OK)
   {
-    Serial.printf("Sound: Failed to install I2S driver: %d\n", err);
-    //while (1); // Halt execution
+    Serial.printf("Sound: Failed to create I2S channel: %d\n", err);
+    return;
   }
 
-  // Set the I2S pins
-  err = i2s_set_pin(I2S_PORT_NUM, &pin_config);
+  // Configure standard (Philips) I2S mode and pins
+  i2s_std_config_t config = {
+    .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(I2S_SAMPLE_RATE),
+    .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_BITS_PER_SAMPLE, I2S_SLOT_MODE_MONO),
+    .gpio_cfg = {
+      .mclk = I2S_MCLK_PIN,
+      .bclk = I2S_BCLK_PIN,
+      .ws = I2S_LRCK_PIN,
+      .dout = I2S_GPIO_UNUSED, // Not transmitting data
+      .din = I2S_DATA_IN_PIN,
+      .invert_flags = { .mclk_inv = false, .bclk_inv = false, .ws_inv = false }
+    }
+  };
+  config.slot_cfg.slot_mask = I2S_NUM_CHANNELS;
+  err = i2s_channel_init_std_mode(soundSensorChannel, &config);
   if (err != ESP_OK)
   {
-    Serial.printf("Sound: Failed to set I2S pins: %d\n", err);
-    //while (1); // Halt execution
+    Serial.printf("Sound: Failed to configure I2S channel: %d\n", err);
+    return;
   }
 
-  // Clear the DMA buffer
-  i2s_zero_dma_buffer(I2S_PORT_NUM);
+  // Hand each filled DMA buffer to the sound task
+  i2s_event_callbacks_t callbacks = { .on_recv = soundSensorReceive, .on_recv_q_ovf = NULL, .on_sent = NULL, .on_send_q_ovf = NULL }; // Overruns are counted in soundSensorReceive(), since the driver's own queue (only used by i2s_channel_read()) is never read
+  i2s_channel_register_event_callback(soundSensorChannel, &callbacks, NULL);
+
+  // Start receiving
+  err = i2s_channel_enable(soundSensorChannel);
+  if (err != ESP_OK)
+  {
+    Serial.printf("Sound: Failed to start I2S channel: %d\n", err);
+  }
 }
 
 // Sound level measurement using I2S (background task)
 void measureSound(void *parameter)
 {
-  // Infinite loop since this is a separate task from the main thread
+  // Infinite loop since this is a separate task from the main thread. The task sleeps until the I2S receive callback queues a filled DMA buffer.
   while (true)
   {
-    // Read the I2S data into the buffer
-    size_t bytesRead = 0;
-    esp_err_t result = i2s_read(I2S_PORT_NUM,                      // I2S port number
-                                soundSensorDataBuffer,             // Buffer to store data
-                                I2S_DMA_BUF_LEN * sizeof(int32_t), // Max bytes to read (buffer size)
-                                &bytesRead,                        // Number of bytes actually read
-                                portMAX_DELAY);                    // Wait indefinitely for data
-    if (result == ESP_OK)
+    SoundBuffer buffer;
+    if (xQueueReceive(soundSensorBuffers, &buffer, portMAX_DELAY) == pdTRUE)
     {
-      if (bytesRead > 0)
+      // Skip a buffer that the DMA already wrapped around to, such as after the task was held up
+      if (soundBufferStale(buffer))
+      {
+        soundSensorOverruns++;
+        continue;
+      }
+
+      // Filter and measure the samples directly in the DMA buffer, and track the level once per second. SPH0645 data is a signed 18-bit value in the upper bits of each 32-bit sample.
+      taskLoadSound.begin();
+      bool second = soundLevelMeter.processFrames(buffer.frames, buffer.size / sizeof(int32_t));
+      if (soundBufferStale(buffer)) soundSensorOverruns++; // Overwritten while it was being measured
+      if (second)
+      {
+        soundSensorSpl.track(soundLevelMeter.levelSecond);
+        soundSnapshot.write({ soundSensorSpl.stats(), soundLevelMeter.leq, soundLevelMeter.lmax, soundLevelMeter.l90 }); // Publish for the other tasks
+        metricsDirty[METRICS_SOUND] = true;
+      }
+      taskLoadSound.end();
+
+      // In power save mode, stop the I2S clock between measured seconds, which also puts the SPH0645 to sleep
+      if (second && powerSaveMode && POWER_SAVE_SOUND_DUTY > 1)
       {
-        // Process the samples
-        int32_t minValue = 0, maxValue = 0; // Initialize min/max values
-        int samplesRead = bytesRead / sizeof(int32_t); // Calculate the number of 32-bit samples read
-        for (int i = 0; i < samplesRead; i++)
-        {
-          // SPH0645 data is in the upper 18 bits of the 32-bit sample
-          // NOTE: The 32-bit sample is unsigned, which MUST be cast to unsigned before shifting bits to avoid the sign bit potentially carrying over to the upper bits
-          int32_t s = ((unsigned int)soundSensorDataBuffer[i]) >> (32 - 18);
-
-          // Calculate the rage of the samples
-          if (s < minValue || minValue == 0)
-          {
-            if (s != 0) minValue = s; // Ignore zero values for the min value after initialization
-          }
-          if (s > maxValue) maxValue = s;
-        }
-
-        // Rough calculation of the sound pressure level (SPL) in dB based on the measured samples. It's more like the dB range rather than an absolute dB level, but the scaling factor helps compensate for that.
-        float spl = SPL_FACTOR * log10(maxValue - minValue);
-
-        // Update the sound level values
-        xSemaphoreTake(xMutexSoundSensor, portMAX_DELAY); // Start accessing the sound sensor data
-        soundSensorSpl.track(spl);
-        xSemaphoreGive(xMutexSoundSensor); // Done with sound sensor data
+        i2s_channel_disable(soundSensorChannel);
+        vTaskDelay(pdMS_TO_TICKS((POWER_SAVE_SOUND_DUTY - 1) * 1000));
+        xQueueReset(soundSensorBuffers); // Discard buffers from before the pause
+        i2s_channel_enable(soundSensorChannel);
+        xQueueReceive(soundSensorBuffers, &buffer, portMAX_DELAY); // Discard the first buffer while the sensor wakes up
       }
     }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if BENCHMARK_ENABLE
+
+// Discards everything written to it, so rendering can be timed without a client
+class NullWriter : public ResponseWriter
+{
+  public:
+    void write(const char* data, size_t size) override {}
+};
+
+// Cycle count statistics for one benchmark
+struct BenchmarkResult
+{
+  const char* name;
+  uint32_t min, median, p99;
+};
+#define BENCHMARK_CASES 5
+BenchmarkResult benchmarkResults[BENCHMARK_CASES];
+SemaphoreHandle_t benchmarkDone; // Given by the benchmark task when the results are ready
+
+// Run a function BENCHMARK_ITERATIONS times, passing the iteration number, and record the min/median/p99 cycle counts
+template <typename Function>
+void benchmarkRun(BenchmarkResult& result, const char* name, uint32_t* cycles, Function function)
+{
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    uint32_t start = esp_cpu_get_cycle_count();
+    function(i);
+    cycles[i] = esp_cpu_get_cycle_count() - start;
+  }
+  std::sort(cycles, cycles + BENCHMARK_ITERATIONS);
+  result = { name, cycles[0], cycles[BENCHMARK_ITERATIONS / 2], cycles[(BENCHMARK_ITERATIONS * 99 + 99) / 100 - 1] }; // Nearest-rank percentiles
+}
+
+// Benchmark task, which is pinned to one core because the cycle counter is per core. Each hot path runs with synthetic data or scratch copies, so
+// the live trackers and data tiers aren't changed.
+void benchmarkTask(void *parameter)
+{
+  uint32_t* cycles = new uint32_t[BENCHMARK_ITERATIONS];
+  NullWriter out;
+
+  // MeasurementTracker::track() on a full window, so the oldest value is expired each time
+  MeasurementTracker* tracker = new MeasurementTracker(MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT));
+  for (int i = 0; i < MEASUREMENT_TRACKING_DATA_POINTS(I2C_INTERVAL_ENVIRONMENT); i++) tracker->track(20.0F + (i % 37) * 0.1F);
+  benchmarkRun(benchmarkResults[0], "tracker_track", cycles, [&](int i) { tracker->track(20.0F + (i % 41) * 0.1F); });
+  delete tracker;
+
+  // updateDataSet(), appending to scratch tiers
+  DataHistory raw, tier15m, tierDaily;
+  DataRollup rollup15m(DATA_VALUE_STREAMS, 15 * 60), rollupDaily(DATA_VALUE_STREAMS, 24 * 60 * 60);
+  void* memory[3] = {
+    ps_malloc(DataHistory::memoryRequired(BENCHMARK_ITERATIONS, DATA_VALUE_STREAMS)),
+    ps_malloc(DataHistory::memoryRequired(BENCHMARK_ITERATIONS, DATA_VALUE_STREAMS * DATA_ROLLUP_STATS)),
+    ps_malloc(DataHistory::memoryRequired(BENCHMARK_ITERATIONS, DATA_VALUE_STREAMS * DATA_ROLLUP_STATS))
+  };
+  raw.begin(memory[0], BENCHMARK_ITERATIONS, DATA_VALUE_STREAMS);
+  tier15m.begin(memory[1], BENCHMARK_ITERATIONS, DATA_VALUE_STREAMS * DATA_ROLLUP_STATS);
+  tierDaily.begin(memory[2], BENCHMARK_ITERATIONS, DATA_VALUE_STREAMS * DATA_ROLLUP_STATS);
+  float sample[DATA_VALUE_STREAMS];
+  benchmarkRun(benchmarkResults[1], "update_data_set", cycles, [&](int i) {
+    readDataSample(sample);
+    raw.append(i * UPDATE_INTERVAL_DATA, sample);
+    rollup15m.add(i * UPDATE_INTERVAL_DATA, sample, tier15m);
+    rollupDaily.add(i * UPDATE_INTERVAL_DATA, sample, tierDaily);
+  });
+  for (void* m : memory) free(m);
+
+  // Dashboard and metrics rendering
+  benchmarkRun(benchmarkResults[2], "render_dashboard", cycles, [&](int i) { webRenderDashboard(out); out.flush(); });
+  benchmarkRun(benchmarkResults[3], "render_metrics", cycles, [&](int i) {
+    {
+      MetricsWriter metrics(out, METRICS_FORMAT_TEXT, METRICS_LABELS ? WIFI_HOSTNAME : nullptr, nullptr);
+      webRenderEnvironmentMetrics(metrics); webRenderSoundMetrics(metrics); webRenderLightMetrics(metrics); webRenderBatteryMetrics(metrics);
+    }
+    out.flush(); // Uncached, as if every section changed
+  });
+
+  // Sound level meter on one DMA buffer of a 1 kHz tone at -20 dBFS
+  SoundLevelMeter* meter = new SoundLevelMeter(SPL_CALIBRATION_OFFSET, SOUND_LEQ_WINDOW);
+  int32_t* frames = new int32_t[I2S_DMA_BUF_LEN];
+  for (int i = 0; i < I2S_DMA_BUF_LEN; i++)
+  {
+    frames[i] = (int32_t)(0.1F * sinf(2.0F * PI * 1000.0F * i / I2S_SAMPLE_RATE) * (1 << (SOUND_LEVEL_FRAME_BITS - 1))) << (32 - SOUND_LEVEL_FRAME_BITS);
+  }
+  benchmarkRun(benchmarkResults[4], "sound_level_buffer", cycles, [&](int i) { meter->processFrames(frames, I2S_DMA_BUF_LEN); });
+  delete[] frames;
+  delete meter;
+
+  delete[] cycles;
+  xSemaphoreGive(benchmarkDone);
+  vTaskDelete(NULL);
+}
+
+// Web server "/bench" GET handler, which runs the benchmarks and returns the results as JSON
+void webHandlerBench()
+{
+  xTaskCreatePinnedToCore(benchmarkTask, "benchmark", 12000, NULL, 1, NULL, BENCHMARK_CORE);
+  xSemaphoreTake(benchmarkDone, portMAX_DELAY);
 
-    //
-    delay(10); // Non-blocking delay on ESP32, in milliseconds
+  WebResponseWriter out(200, "application/json");
+  out.printf("{\"firmware\":\"%s %s\",\"cpu_mhz\":%d,\"iterations\":%d,\"results\":[", __DATE__, __TIME__, (int)getCpuFrequencyMhz(), BENCHMARK_ITERATIONS);
+  for (int b = 0; b < BENCHMARK_CASES; b++)
+  {
+    const BenchmarkResult& r = benchmarkResults[b];
+    out.printf("%s{\"name\":\"%s\",\"min\":%u,\"median\":%u,\"p99\":%u}", b ? "," : "", r.name, (unsigned int)r.min, (unsigned int)r.median, (unsigned int)r.p99);
   }
+  out.print("]}");
+  out.end();
+}
+
+// Register the "/bench" endpoint
+void setupBenchmark()
+{
+  benchmarkDone = xSemaphoreCreateBinary();
+  webServer.on("/bench", webHandlerBench);
 }
 
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Main Setup
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1130,11 +2353,16 @@ void setup()
   configTzTime(NTP_TIMEZONE, NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3); // NTP
 
   // Semaphore setup
-  xMutexEnvironmental = xSemaphoreCreateMutex();
-  xMutexUptime        = xSemaphoreCreateMutex();
-  xMutexBattery       = xSemaphoreCreateMutex();
-  xMutexSoundSensor   = xSemaphoreCreateMutex();
-  xMutexLightSensor   = xSemaphoreCreateMutex();
+  xMutexUptime  = xSemaphoreCreateMutex();
+  xMutexDataSet = xSemaphoreCreateMutex();
+
+  // Restore the data history from flash
+  setupDataLog();
+
+  // Benchmark endpoint
+  #if BENCHMARK_ENABLE
+    setupBenchmark();
+  #endif
 
   // Sensor setup
   delay(200); // Allow the sensor modules time to initialize after powering on
@@ -1154,26 +2382,39 @@ void setup()
   pinMode(AC_POWER_PIN, INPUT_PULLDOWN);
 
   // Chip information
+  cpuFrequencyFull = getCpuFrequencyMhz();
   sprintf(chipInformation, "%s %s (revison v%d.%d), %dMHz, %dMB Flash, %dMB PSRAM", ESP.getChipModel(), ESP.getCoreVersion(), efuse_hal_get_major_chip_version(), efuse_hal_get_minor_chip_version(), ESP.getCpuFreqMHz(), ESP.getFlashChipSize()/1024/1024, ESP.getPsramSize()/1024/1024);
 
-  // Create a task for reading all of the I2C devices
-  xTaskCreate(
-    readI2CDevices,   // Function to be called
-    "readI2CDevices", // Name of the task
+  // The Arduino loop() runs in the same task as setup()
+  taskHandleLoop = xTaskGetCurrentTaskHandle();
+
+  // Create the sensor tasks on one core and the web server task on the other (see TASK_CORE_* and TASK_PRIORITY_* in config.h)
+  xTaskCreatePinnedToCore(
+    readI2CDevices,    // Function to be called
+    "readI2CDevices",  // Name of the task
     12000,             // Stack size
-    NULL,             // Parameter to pass
-    1,                // Task priority
-    NULL              // Task handle
+    NULL,              // Parameter to pass
+    TASK_PRIORITY_I2C, // Task priority
+    &taskHandleI2C,    // Task handle
+    TASK_CORE_SENSORS  // CPU core
   );
-
-  // Create a task for reading sound levels
-  xTaskCreate(
-    measureSound,   // Function to be called
-    "measureSound", // Name of the task
-    6000,           // Stack size
-    NULL,           // Parameter to pass
-    1,              // Task priority
-    NULL            // Task handle
+  xTaskCreatePinnedToCore(
+    measureSound,        // Function to be called
+    "measureSound",      // Name of the task
+    6000,                // Stack size
+    NULL,                // Parameter to pass
+    TASK_PRIORITY_SOUND, // Task priority
+    &taskHandleSound,    // Task handle
+    TASK_CORE_SENSORS    // CPU core
+  );
+  xTaskCreatePinnedToCore(
+    serveWeb,          // Function to be called
+    "serveWeb",        // Name of the task
+    8000,              // Stack size
+    NULL,              // Parameter to pass
+    TASK_PRIORITY_WEB, // Task priority
+    &taskHandleWeb,    // Task handle
+    TASK_CORE_NETWORK  // CPU core
   );
 }
 
@@ -1183,8 +2424,10 @@ void setup()
 
 void loop()
 {
+  taskLoadLoop.begin();
+
   // Uptime calculations: How long has the ESP32 been running since it was booted up?
-  xSemaphoreTake(xMutexUptime, portMAX_DELAY); // Start accessing the uptime data
+  takeMutex(xMutexUptime, mutexWaitUptime); // Start accessing the uptime data
   bool newSecond = false;
   uptimeSecondsTotal = systemSeconds();
   if (uptimeSecondsTotal > lastUptimeSecondsTotal)
@@ -1203,11 +2446,13 @@ void loop()
   timer = uptimeSecondsTotal; // Copy the timer so it can be used without the semaphore
   xSemaphoreGive(xMutexUptime); // Done with uptime data
 
+  // Apply a power mode change requested by the battery monitor
+  bool powerSaveRequested = batterySnapshot.read().powerSaveRequested;
+  if (powerSaveRequested != powerSaveMode) setPowerSaveMode(powerSaveRequested);
+
   // MQTT connection management
   if (!mqttClient.connected()) connectMQTT(); else mqttClient.loop();
-
-  // Web server request management
-  webServer.handleClient();
+  mqttConnected = mqttClient.connected();
 
   // Update outputs every specified update interval, and usually the first-time through the loop()
   bool updateTft  = timer - lastUpdateTimeTft >= UPDATE_INTERVAL_TFT;
@@ -1217,12 +2462,24 @@ void loop()
       updateDisplay();
       lastUpdateTimeTft = timer;
   }
-  bool updateMqtt = timer - lastUpdateTimeMqtt >= UPDATE_INTERVAL_MQTT;
+  bool updateMqtt = timer - lastUpdateTimeMqtt >= (powerSaveMode ? POWER_SAVE_MQTT_INTERVAL : UPDATE_INTERVAL_MQTT);
   if (updateMqtt || lastUpdateTimeMqtt == 0)
   {
-      // Update MQTT
-      updateMQTT();
+      // Update MQTT with every value (the heartbeat), or queue a sample to send later if the broker can't be reached
+      if (mqttClient.connected()) updateMQTT(true); else if (lastUpdateTimeMqtt != 0) queueMQTTSample();
       lastUpdateTimeMqtt = timer;
+      lastCheckTimeMqtt = timer;
+  }
+  else if (timer - lastCheckTimeMqtt >= UPDATE_INTERVAL_MQTT_CHECK && mqttClient.connected() && !powerSaveMode) // Batched into the heartbeat in power save mode
+  {
+      // Update MQTT with the values that changed
+      updateMQTT(false);
+      lastCheckTimeMqtt = timer;
+  }
+  else
+  {
+      // Send queued samples from the last outage between live updates
+      sendMQTTQueue();
   }
   bool updateData = timer - lastUpdateTimeData >= UPDATE_INTERVAL_DATA;
   if (updateData) // Don't want to capture data the first time through the loop() because there likely won't be any useful data
@@ -1232,17 +2489,26 @@ void loop()
       lastUpdateTimeData = timer;
   }
 
-  // Turn on the TFT display backlight for a few seconds when a button is pressed. The display is constantly updated, so buttons just turn the backlight on/off.
+  // Turn on the TFT display backlight for a few seconds when a button is pressed. The display is only updated while the backlight is on, so it's
+  // brought up to date right away. The panel keeps its contents while the backlight is off, so only the lines that changed are drawn.
   if (digitalRead(0) == 0 || digitalRead(1) || digitalRead(1)) // NOTE: D0 is different
   {
     displayTimer = timer;
-    digitalWrite(TFT_BACKLITE, HIGH); // Power on the TFT backlight
+    if (!displayOn)
+    {
+      digitalWrite(TFT_BACKLITE, HIGH); // Power on the TFT backlight
+      displayOn = true;
+      updateDisplay();
+      lastUpdateTimeTft = timer;
+    }
   }
-  else if (timer - displayTimer == TFT_TIMEOUT)
+  else if (displayOn && timer - displayTimer >= TFT_TIMEOUT)
   {
     digitalWrite(TFT_BACKLITE, LOW); // Power off the TFT backlight
+    displayOn = false;
   }
 
   // Yield to other tasks, and slow down the main loop a little
+  taskLoadLoop.end();
   delay(5); // Non-blocking delay on ESP32, in milliseconds
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+/**
+ * @file  Seqlock.h
+ * @brief Helper class to share a snapshot of plain data between tasks without blocking the task that publishes it
+ */
+
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#include <stdint.h>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+  #define SEQLOCK_BACKOFF() vTaskDelay(1) // Let a preempted writer on the same core finish
+#else
+  #define SEQLOCK_BACKOFF()
+#endif
+
+#define SEQLOCK_SPIN_RETRIES 8 // Number of immediate retries before a reader starts yielding to other tasks
+
+// Sequence lock for a POD snapshot with a single writer task. The writer bumps the sequence number to an odd value, copies the new snapshot in,
+// and bumps it back to an even value. Readers copy the snapshot and retry if the sequence number was odd or changed during the copy, so the writer
+// never waits on a reader and a reader never sees a half-written snapshot.
+template <typename T>
+class Seqlock
+{
+  private:
+    volatile uint32_t sequence = 0; // Odd while the writer is copying a new snapshot in
+    T value = {};                   // Current snapshot
+
+  public:
+    // Publish a new snapshot. Only one task may call this for a given instance.
+    void write(const T& snapshot)
+    {
+      sequence = sequence + 1;
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      value = snapshot;
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      sequence = sequence + 1;
+    }
+
+    // Sequence number, which changes each time a snapshot is published, so a reader can tell when there is something new without copying it
+    uint32_t version() const { return sequence; }
+
+    // Copy a consistent snapshot
+    T read() const
+    {
+      T snapshot;
+      for (int attempt = 0; ; attempt++)
+      {
+        uint32_t before = sequence;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        snapshot = value;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (!(before & 1) && sequence == before) return snapshot;
+        if (attempt >= SEQLOCK_SPIN_RETRIES) SEQLOCK_BACKOFF();
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file  SoundLevelMeter.h
+ * @brief A-weighted sound level meter for I2S microphone samples, with Leq, Lmax and L90 statistics
+ */
+
+#ifndef __SOUND_LEVEL_METER_H__
+#define __SOUND_LEVEL_METER_H__
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#if __has_include(<esp_dsp.h>)
+  #include <esp_dsp.h> // Espressif DSP library with ESP32-S3 SIMD versions of the filter and dot product functions
+  #define SOUND_LEVEL_METER_ESP_DSP
+#endif
+
+#define SOUND_LEVEL_SAMPLE_RATE  16000 // The A-weighting coefficients below are designed for this sample rate
+#define SOUND_LEVEL_FAST_SAMPLES (SOUND_LEVEL_SAMPLE_RATE / 8) // 125ms "fast" interval, which is used for Lmax and L90
+#define SOUND_LEVEL_CHUNK        256   // Number of samples filtered at a time
+#define SOUND_LEVEL_DC_POLE      0.996F // DC blocker pole, for a cutoff of about 10 Hz
+#define SOUND_LEVEL_BIN_WIDTH    0.5F  // dB per bin of the L90 histogram
+#define SOUND_LEVEL_BINS         280   // The L90 histogram covers 0-140 dB
+#define SOUND_LEVEL_FRAME_BITS   18    // Number of valid bits at the top of each 32-bit I2S frame (SPH0645)
+
+// Samples go through a DC blocker and an A-weighting filter, and the mean square of the result is accumulated over 125ms intervals. Every second, the
+// 1-second A-weighted equivalent level (Leq) is updated. Over each window of the specified number of seconds, the Leq, max 125ms level (Lmax) and level
+// exceeded 90% of the time (L90) are calculated. Levels are in dB, where "calibration" is the level of a full-scale sine wave.
+class SoundLevelMeter
+{
+  private:
+    // A-weighting filter as a cascade of three biquads, each stored as { b0, b1, b2, a1, a2 }. The first two are bilinear transforms of the 20.6 Hz, 107.7 Hz
+    // and 737.9 Hz poles. The 12.2 kHz double pole is above the Nyquist frequency, so the third section is a short FIR fit to it that also holds the gain
+    // for 0 dB at 1 kHz. The response is within 0.2 dB of the IEC 61672 curve from 20 Hz to 7.6 kHz.
+    float coefficients[3][5] = {
+      { 0.99195961F, -1.98391921F,  0.99195961F, -1.98388676F, 0.98395167F },
+      { 0.85537430F, -1.71074860F,  0.85537430F, -1.70550963F, 0.71598758F },
+      { 1.10605677F,  0.16590851F, -0.02212114F,  0.0F,        0.0F        }
+    };
+    float state[3][2] = {};         // Direct form II delay line of each biquad
+    float dcInput = 0, dcOutput = 0; // DC blocker state
+    float work[2][SOUND_LEVEL_CHUNK]; // Filter input/output buffers
+
+    float calibration;      // Level of a full-scale sine wave
+    int windowLength;       // Seconds per Leq/Lmax/L90 window
+    double fastSum = 0;     // Sum of squares in the current 125ms interval
+    int fastCount = 0;      // Number of samples in the current 125ms interval
+    double secondSum = 0;   // Sum of the 125ms sums of squares in the current second
+    int secondCount = 0;    // Number of 125ms intervals in the current second
+    double windowSum = 0;   // Sum of the 1-second mean squares in the current window
+    int windowCount = 0;    // Number of seconds in the current window
+    float windowMax;        // Max 125ms level in the current window
+    uint16_t histogram[SOUND_LEVEL_BINS]; // Count of 125ms levels in the current window by bin
+    int histogramCount = 0; // Number of 125ms levels in the histogram
+    bool windowDone = false; // True once the first window has been completed
+
+    // Convert a mean square value to a level in dB, where a full-scale sine wave (mean square of 0.5) is "calibration" dB
+    float level(double meanSquare) const
+    {
+      return 10.0F * log10f((float)(2.0 * meanSquare) + 1e-20F) + calibration;
+    }
+
+    // Filter one chunk of samples, and return the sum of squares of the filtered samples
+    float filter(float* x, int n)
+    {
+      // DC blocker: y[n] = x[n] - x[n-1] + R * y[n-1]
+      for (int i = 0; i < n; i++)
+      {
+        float in = x[i];
+        dcOutput = in - dcInput + SOUND_LEVEL_DC_POLE * dcOutput;
+        dcInput = in;
+        x[i] = dcOutput;
+      }
+
+      // A-weighting and sum of squares
+      float* in = x;
+      float* out = x == work[0] ? work[1] : work[0];
+      #ifdef SOUND_LEVEL_METER_ESP_DSP
+        for (int s = 0; s < 3; s++)
+        {
+          dsps_biquad_f32(in, out, n, coefficients[s], state[s]);
+          float* t = in; in = out; out = t;
+        }
+        float sum;
+        dsps_dotprod_f32(in, in, &sum, n);
+        return sum;
+      #else
+        for (int s = 0; s < 3; s++)
+        {
+          const float* c = coefficients[s];
+          float w0 = state[s][0], w1 = state[s][1];
+          for (int i = 0; i < n; i++)
+          {
+            float d = in[i] - c[3] * w0 - c[4] * w1;
+            out[i] = c[0] * d + c[1] * w0 + c[2] * w1;
+            w1 = w0;
+            w0 = d;
+          }
+          state[s][0] = w0;
+          state[s][1] = w1;
+          float* t = in; in = out; out = t;
+        }
+        float sum = 0;
+        for (int i = 0; i < n; i++) sum += in[i] * in[i];
+        return sum;
+      #endif
+    }
+
+    // Update the Leq/Lmax/L90 values from the current window
+    void updateWindow()
+    {
+      leq = level(windowSum / windowCount);
+      lmax = windowMax;
+      int target = histogramCount / 10; // L90 is exceeded by 90% of the 125ms levels, so 10% are at or below it
+      int total = 0;
+      int bin = 0;
+      while (bin < SOUND_LEVEL_BINS - 1 && total + histogram[bin] <= target) total += histogram[bin++];
+      l90 = (bin + 0.5F) * SOUND_LEVEL_BIN_WIDTH;
+    }
+
+    // Start a new window
+    void resetWindow()
+    {
+      windowSum = 0;
+      windowCount = 0;
+      windowMax = -INFINITY;
+      memset(histogram, 0, sizeof(histogram));
+      histogramCount = 0;
+    }
+
+    // Number of samples to filter next, which stops at the end of the current 125ms interval
+    int chunkSize(int count) const
+    {
+      int n = SOUND_LEVEL_FAST_SAMPLES - fastCount;
+      if (n > SOUND_LEVEL_CHUNK) n = SOUND_LEVEL_CHUNK;
+      return n < count ? n : count;
+    }
+
+    // Convert I2S frames to samples. The arithmetic shift keeps the sign, and the loop has no branches so the compiler can unroll and pipeline it.
+    static void convert(const int32_t* __restrict frames, float* __restrict samples, int n)
+    {
+      const float scale = 1.0F / (float)(1 << (SOUND_LEVEL_FRAME_BITS - 1));
+      for (int i = 0; i < n; i++)
+      {
+        samples[i] = (float)(frames[i] >> (32 - SOUND_LEVEL_FRAME_BITS)) * scale;
+      }
+    }
+
+    // Filter and measure the n samples in the first work buffer. Returns true at the end of a second.
+    bool measure(int n)
+    {
+      fastSum += filter(work[0], n);
+      fastCount += n;
+      if (fastCount < SOUND_LEVEL_FAST_SAMPLES) return false;
+
+      // End of a 125ms interval
+      float fast = level(fastSum / SOUND_LEVEL_FAST_SAMPLES);
+      if (fast > windowMax) windowMax = fast;
+      int bin = (int)(fast / SOUND_LEVEL_BIN_WIDTH);
+      histogram[bin < 0 ? 0 : bin >= SOUND_LEVEL_BINS ? SOUND_LEVEL_BINS - 1 : bin]++;
+      histogramCount++;
+      secondSum += fastSum;
+      secondCount++;
+      fastSum = 0;
+      fastCount = 0;
+      if (secondCount < 8) return false;
+
+      // End of a second
+      double meanSquare = secondSum / SOUND_LEVEL_SAMPLE_RATE;
+      levelSecond = level(meanSquare);
+      windowSum += meanSquare;
+      windowCount++;
+      secondSum = 0;
+      secondCount = 0;
+      if (windowCount >= windowLength)
+      {
+        updateWindow();
+        resetWindow();
+        windowDone = true;
+      }
+      else if (!windowDone)
+      {
+        updateWindow();
+      }
+      return true;
+    }
+
+  public:
+    float levelSecond = NAN; // A-weighted equivalent level over the last second
+    float leq = NAN;         // A-weighted equivalent level over the last window
+    float lmax = NAN;        // Max A-weighted 125ms level over the last window
+    float l90 = NAN;         // A-weighted 125ms level exceeded 90% of the time over the last window
+
+    // Constructor
+    SoundLevelMeter(float calibrationLevel, int windowSeconds)
+    {
+      calibration = calibrationLevel;
+      windowLength = windowSeconds > 0 ? windowSeconds : 1;
+      resetWindow();
+    }
+
+    // Filter and measure a block of samples, which are scaled so that full scale is +/-1.0. Returns true when a new 1-second level is ready.
+    // Until the first window is complete, the window values are updated every second from the partial window.
+    bool process(const float* samples, int count)
+    {
+      bool ready = false;
+      while (count > 0)
+      {
+        int n = chunkSize(count);
+        memcpy(work[0], samples, n * sizeof(float));
+        ready |= measure(n);
+        samples += n;
+        count -= n;
+      }
+      return ready;
+    }
+
+    // Same as process(), but for raw 32-bit I2S frames with a signed sample in the upper SOUND_LEVEL_FRAME_BITS bits. The frames are converted straight
+    // into the filter buffer, so no separate sample buffer is needed.
+    bool processFrames(const int32_t* frames, int count)
+    {
+      bool ready = false;
+      while (count > 0)
+      {
+        int n = chunkSize(count);
+        convert(frames, work[0], n);
+        ready |= measure(n);
+        frames += n;
+        count -= n;
+      }
+      return ready;
+    }
+};
+
+#endif
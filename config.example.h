@@ -33,7 +33,7 @@ IPAddress webAllowedClients[] = {
 #define BME680_TEMP_F true        // Set to false for Celsius
 #define BME680_TEMP_OFFSET -2.00F // Celsius temperature offset for BME680. Adjust until temperature readings stabilize and match a known reference.
 #define BME680_DONCHIAN_ENABLE               true     // Whether Donchian smoothing is enabled for IAQ
-#define BME680_DONCHIAN_WINDOW               800      // Donchian smoothing period in number of I2C_INTERVAL polling cycles (default is 6 seconds X this value = smoothing period in seconds)
+#define BME680_DONCHIAN_WINDOW               1600     // Donchian smoothing period in number of BME680 readings (default is 3 seconds X this value = smoothing period in seconds)
 #define BME680_DONCHIAN_TEMP_RANGE_LIMIT     2.5F     // Donchian range limit for temperature in Celsius (only used in IAQ calculation)
 #define BME680_DONCHIAN_HUMIDITY_RANGE_LIMIT 3.5F     // Donchian range limit for humidity in degrees RH (only used in IAQ calculation)
 #define BME680_DONCHIAN_GAS_RANGE_LIMIT      12500.0F // Donchian range limit for gas resistance (only used in IAQ calculation)
@@ -43,19 +43,39 @@ IPAddress webAllowedClients[] = {
 #define I2S_LRCK_PIN        9                 // Left/Right Clock (Word Select)
 #define I2S_BCLK_PIN        6                 // Bit Clock
 #define I2S_DATA_IN_PIN     5                 // Data In (DOUT from SPH0645)
-#define I2S_MCLK_PIN        I2S_PIN_NO_CHANGE // MCLK pin is not used for SPH0645
-#define I2S_DMA_BUF_COUNT   8                 // Number of DMA buffers
-#define I2S_DMA_BUF_LEN     256               // Size of each DMA buffer in samples
+#define I2S_MCLK_PIN        I2S_GPIO_UNUSED   // MCLK pin is not used for SPH0645
+#define I2S_DMA_BUF_COUNT   6                 // Number of DMA buffers
+#define I2S_DMA_BUF_LEN     1000              // Size of each DMA buffer in samples (62.5ms at 16 kHz, and at most 1023). The sound task runs once per buffer.
 #define I2S_SAMPLE_RATE     16000             // Audio sample rate (Hz)
-#define I2S_BITS_PER_SAMPLE I2S_BITS_PER_SAMPLE_32BIT // SPH0645 outputs data in 32-bit frames (even if only 18-24 bits are valid)
-#define I2S_NUM_CHANNELS    I2S_CHANNEL_FMT_ONLY_LEFT // SPH0645 is mono, usually on the left channel
-#define SPL_FACTOR          17.5 // Factor to convert the range of the samples to dB SPL (Sound Pressure Level) using the formula: SPL = FACTOR * log10(max - min), where max and min are the maximum and minimum sample values, respectively
+#define I2S_BITS_PER_SAMPLE I2S_DATA_BIT_WIDTH_32BIT // SPH0645 outputs data in 32-bit frames (even if only 18-24 bits are valid)
+#define I2S_NUM_CHANNELS    I2S_STD_SLOT_LEFT // SPH0645 is mono, usually on the left channel
+#define SPL_CALIBRATION_OFFSET 136.0 // dB SPL of a full-scale sine wave. The SPH0645 sensitivity is -42 dBFS at 94 dB SPL, so this is 94 + 42 = 136.
+#define SOUND_LEQ_WINDOW       60    // Seconds. The Leq (energy average), Lmax and L90 sound levels are calculated over consecutive windows of this length.
 
 // AC power sensing pin
 #define AC_POWER_PIN 10 // Attached to the center of the 5V/3.3V resister divider such that the pin gets 3.3V when 5V power exists on the USB bus
 
+// Power save mode, which is used while running on the battery (AC power off)
+#define POWER_SAVE_ENABLE        true // Switch to power save mode when AC power is lost, and back to full power mode when it returns
+#define POWER_SAVE_CPU_MHZ       80   // CPU frequency in power save mode (80, 160 or 240). WiFi needs at least 80.
+#define POWER_SAVE_SOUND_DUTY    4    // In power save mode, sound is measured for one second out of every this many seconds
+#define POWER_SAVE_I2C_FACTOR    5    // In power save mode, the light sensor and battery monitor are read this many times less often
+#define POWER_SAVE_MQTT_INTERVAL 300  // Seconds between MQTT updates in power save mode, which include every value since changes aren't published in between
+
+// Task scheduling. loop() (MQTT, the TFT display and the data history) always runs on core 1 at priority 1, and the WiFi driver runs on core 0.
+#define TASK_CORE_SENSORS   0 // CPU core for the sound and I2C tasks, which keeps sensor timing away from the network and display work on core 1
+#define TASK_CORE_NETWORK   1 // CPU core for the web server task, which shares the core with loop()
+#define TASK_PRIORITY_SOUND 4 // Sound task priority, the highest so each DMA buffer is measured before the DMA wraps back around to it
+#define TASK_PRIORITY_I2C   3 // I2C task priority, which keeps the BME680 IAQ readings on schedule
+#define TASK_PRIORITY_WEB   1 // Web server task priority, the same as loop() so the two share core 1 evenly
+
 // General measurement configuration
 #define MEASUREMENT_WINDOW 3600 // Seconds. Measurements will have min/average/max values calculated over this time period.
+#define MEASUREMENT_PSRAM  true // Keep the min/average/max windows in one PSRAM block instead of the internal SRAM that WiFi and TLS need
+#define MEASUREMENT_PACKED true // Store the windows as 16-bit fixed point values with 0.01 resolution (except light), which cuts each window from 8 to 6 bytes per data point including the min/max index queues
+#define MEASUREMENT_OPERATORS_ENVIRONMENT (MEASUREMENT_EMA | MEASUREMENT_STDDEV | MEASUREMENT_RATE)      // Summary values for temperature, dew point, humidity, pressure and IAQ
+#define MEASUREMENT_OPERATORS_SOUND       (MEASUREMENT_EMA | MEASUREMENT_QUANTILES | MEASUREMENT_STDDEV) // Summary values for the 1-second sound level
+#define MEASUREMENT_OPERATORS_LIGHT       0                                                             // Summary values for the light level (0 for none)
 
 // Max update delays. Outputs will be refreshed at least this often.
 #define UPDATE_INTERVAL_MQTT    60
@@ -64,6 +84,20 @@ IPAddress webAllowedClients[] = {
 
 // HTML history charts (PSRAM data storage)
 #define DATA_HISTORY_COUNT    2880 // Number of data elements to keep per stream, with one element per UPDATE_INTERVAL_DATA
+#define DATA_HISTORY_COUNT_15M   2976 // Number of 15-minute min/average/max rollup elements to keep per stream (2976 = 31 days)
+#define DATA_HISTORY_COUNT_DAILY 366  // Number of daily min/average/max rollup elements to keep per stream (366 = one year)
+#define DATA_LOG_ENABLE          true // Save the data history to flash (LittleFS) so the charts survive a reboot or power outage
+#define DATA_LOG_BATCH           10   // Number of data elements collected in memory before they are written to flash together
+
+// Benchmarks
+#define BENCHMARK_ENABLE     false // Enable the "/bench" web endpoint, which times the hot code paths in CPU cycles. Running it briefly delays the other tasks.
+#define BENCHMARK_ITERATIONS 200   // Number of times each benchmark is run
+#define BENCHMARK_CORE       1     // CPU core for the benchmark task
+
+// Prometheus metrics
+#define METRICS_LABELS      false // Use host and stat labels in the Prometheus text format, rather than a separate metric name for each statistic
+#define METRICS_OPENMETRICS false // Answer scrapers that accept OpenMetrics with the OpenMetrics text format (always labeled)
+#define METRICS_PROTOBUF    false // Answer scrapers that accept the Prometheus protobuf format with it (always labeled)
 
 // MQTT configuration
 const char* MQTT_SERVER   = "192.168.1.60"; // MQTT server name or IP
@@ -71,6 +105,29 @@ const int   MQTT_PORT     = 8883;           // 1883 is the default port for MQTT
 const char* MQTT_USER     = "MQTT user";    // Null if no authentication is required
 const char* MQTT_PASSWORD = "MQTT pass";    // Null if no authentication is required
 #define     MQTT_TOPIC_BASE "home/sensors/ambient_1/" // Base topic string for all values from this sensor
+#define     MQTT_PUBLISH_STATE  true // Publish all values as one JSON document to MQTT_TOPIC_BASE "state" each interval
+#define     MQTT_PUBLISH_FIELDS true // Also publish each value to its own topic under MQTT_TOPIC_BASE (set to false to only use the JSON document)
+#define     MQTT_KEEPALIVE      60   // Seconds between MQTT keepalive pings, which keep the connection open through NAT and firewall idle timeouts
+#define     MQTT_RECONNECT_MIN  5    // Seconds to wait after a failed connection attempt, which doubles after each failure
+#define     MQTT_RECONNECT_MAX  300  // Max seconds between connection attempts
+#define     MQTT_QUEUE_COUNT    1440 // Samples to keep in PSRAM while the broker can't be reached, one per heartbeat (1440 = one day at 60 seconds). 0 disables the queue.
+#define     MQTT_QUEUE_BATCH    30   // Queued samples per MQTT message when the queue is sent after reconnecting
+#define     MQTT_QUEUE_INTERVAL 2    // Seconds between queued batches, so live updates aren't held up
+
+// MQTT report-on-change. Values are checked every UPDATE_INTERVAL_MQTT_CHECK seconds, and each one is published when it has changed by more than its
+// deadband since it was last published. Every value is also published every UPDATE_INTERVAL_MQTT seconds as a heartbeat. Each deadband is "absolute, relative",
+// and a value is published when it changes by more than the larger of the absolute amount or the relative fraction of its last published value.
+#define UPDATE_INTERVAL_MQTT_CHECK    5         // Seconds between checks for changed values
+#define MQTT_DEADBAND_TEMPERATURE     0.2, 0    // Degrees, for temperature and dew point
+#define MQTT_DEADBAND_HUMIDITY        1.0, 0    // RH%
+#define MQTT_DEADBAND_PRESSURE        0.5, 0    // mbar
+#define MQTT_DEADBAND_IAQ             1.0, 0    // IAQ and gas calibration accuracy percent
+#define MQTT_DEADBAND_GAS_RESISTANCE  0,   0.05 // Ohms
+#define MQTT_DEADBAND_SOUND           3.0, 0    // dB
+#define MQTT_DEADBAND_LIGHT           1.0, 0.10 // Lux
+#define MQTT_DEADBAND_WIFI            5,   0    // dBm
+#define MQTT_DEADBAND_BATTERY_VOLTAGE 0.05, 0   // Volts
+#define MQTT_DEADBAND_BATTERY_PERCENT 2.0, 0    // Percent
 
 // Certificate Authority for TLS connections
 static const char CERT_CA[] = R"EOF(
@@ -0,0 +1,140 @@
+/**
+ * @file  benchmarks.cpp
+ * @brief Google Benchmark suite for the measurement trackers, data tiers, /data encoders and sound level meter
+ */
+
+#include <math.h>
+#include <vector>
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include <MeasurementTracker.h>
+#include <DataHistory.h>
+#include <DataEncoding.h>
+#include <ResponseWriter.h>
+#include <SoundLevelMeter.h>
+
+#define BENCHMARK_STREAMS 9 // Value streams in a data sample, as in the firmware
+#define BENCHMARK_HISTORY 2880 // DATA_HISTORY_COUNT
+
+// Discards everything written to it
+class NullWriter : public ResponseWriter
+{
+  public:
+    void write(const char* data, size_t) override { benchmark::DoNotOptimize(data); }
+};
+
+// Random walk values, like a slowly changing sensor reading
+std::vector<float> walk(int count, float start, float step)
+{
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0.0F, step);
+  std::vector<float> values(count);
+  float v = start;
+  for (float& x : values) x = v += noise(random);
+  return values;
+}
+
+// MeasurementTracker::track() with the window size as the argument, in incremental and full-rescan modes
+void trackerTrack(benchmark::State& state, bool incremental)
+{
+  int points = (int)state.range(0);
+  std::vector<float> values = walk(4096, 21.0F, 0.05F);
+  MeasurementTracker tracker(points, incremental);
+  for (int i = 0; i < points; i++) tracker.track(values[i % values.size()]); // Start with a full window
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    tracker.track(values[i++ & 4095]);
+    benchmark::DoNotOptimize(tracker.average);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+void BM_MeasurementTrackerIncremental(benchmark::State& state) { trackerTrack(state, true); }
+void BM_MeasurementTrackerRescan(benchmark::State& state) { trackerTrack(state, false); }
+BENCHMARK(BM_MeasurementTrackerIncremental)->Arg(600)->Arg(1200)->Arg(3600);
+BENCHMARK(BM_MeasurementTrackerRescan)->Arg(600)->Arg(1200)->Arg(3600);
+
+// DataHistory::append() of one sample to a full tier
+void BM_DataHistoryAppend(benchmark::State& state)
+{
+  std::vector<char> memory(DataHistory::memoryRequired(BENCHMARK_HISTORY, BENCHMARK_STREAMS));
+  DataHistory tier;
+  tier.begin(memory.data(), BENCHMARK_HISTORY, BENCHMARK_STREAMS);
+  float sample[BENCHMARK_STREAMS] = { 21.0F, 45.0F, 9.0F, 1013.0F, 60.0F, 120.0F, 3.0F, 40.0F, 500.0F };
+  int32_t t = 0;
+  for (auto _ : state)
+  {
+    tier.append(t += 60, sample);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataHistoryAppend);
+
+// DataRollup::add() of one sample, including the appends to the tier at the end of each period
+void BM_DataRollupAdd(benchmark::State& state)
+{
+  std::vector<char> memory(DataHistory::memoryRequired(BENCHMARK_HISTORY, BENCHMARK_STREAMS * DATA_ROLLUP_STATS));
+  DataHistory tier;
+  tier.begin(memory.data(), BENCHMARK_HISTORY, BENCHMARK_STREAMS * DATA_ROLLUP_STATS);
+  DataRollup rollup(BENCHMARK_STREAMS, 15 * 60);
+  float sample[BENCHMARK_STREAMS] = { 21.0F, 45.0F, 9.0F, 1013.0F, 60.0F, 120.0F, 3.0F, 40.0F, 500.0F };
+  int32_t t = 0;
+  for (auto _ : state)
+  {
+    rollup.add(t += 60, sample, tier);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataRollupAdd);
+
+// Binary /data encoding of one full stream
+void BM_DataEncodeValues(benchmark::State& state)
+{
+  std::vector<float> values = walk(BENCHMARK_HISTORY, 21.0F, 0.05F);
+  std::vector<int16_t> words(BENCHMARK_HISTORY * 3);
+  for (auto _ : state)
+  {
+    int32_t previous = 0;
+    benchmark::DoNotOptimize(dataEncodeValues(words.data(), values.data(), BENCHMARK_HISTORY, 0.01F, previous));
+  }
+  state.SetItemsProcessed(state.iterations() * BENCHMARK_HISTORY);
+}
+BENCHMARK(BM_DataEncodeValues);
+
+// Text /data formatting of one full stream
+void BM_DataFormatValues(benchmark::State& state)
+{
+  std::vector<float> values = walk(BENCHMARK_HISTORY, 21.0F, 0.05F);
+  NullWriter out;
+  for (auto _ : state)
+  {
+    dataFormatValues(out, values.data(), BENCHMARK_HISTORY);
+    out.flush();
+  }
+  state.SetItemsProcessed(state.iterations() * BENCHMARK_HISTORY);
+}
+BENCHMARK(BM_DataFormatValues);
+
+// SoundLevelMeter::processFrames() of one I2S DMA buffer (I2S_DMA_BUF_LEN frames)
+void BM_SoundLevelMeterProcessFrames(benchmark::State& state)
+{
+  int count = (int)state.range(0);
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0.0F, 0.01F);
+  std::vector<int32_t> frames(count);
+  for (int i = 0; i < count; i++)
+  {
+    float x = 0.1F * sinf(2.0F * (float)M_PI * 1000.0F * i / SOUND_LEVEL_SAMPLE_RATE) + noise(random);
+    frames[i] = (int32_t)(x * (1 << (SOUND_LEVEL_FRAME_BITS - 1))) << (32 - SOUND_LEVEL_FRAME_BITS);
+  }
+  SoundLevelMeter meter(120.0F, 60);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(meter.processFrames(frames.data(), count));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SoundLevelMeterProcessFrames)->Arg(1000);
+
+BENCHMARK_MAIN();
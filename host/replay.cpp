@@ -0,0 +1,453 @@
+/**
+ * @file  replay.cpp
+ * @brief Host replay tool that feeds recorded or synthetic sensor traces through the measurement trackers, data tiers, rollups and /data encoders
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <chrono>
+
+#include <MeasurementTracker.h>
+#include <DataHistory.h>
+#include <DataEncoding.h>
+#include <ResponseWriter.h>
+
+// Pipeline settings, which match the defaults in config.example.h and Sensor-Ambient.ino
+#define REPLAY_STREAMS            9    // Value streams, in /data stream order: temperature, humidity, dew point, pressure, IAQ, gas resistance, gas accuracy, sound, light
+#define REPLAY_SAMPLE_INTERVAL    3    // Seconds between samples in a synthetic trace, which is the BME680 sample rate (I2C_INTERVAL_ENVIRONMENT)
+#define REPLAY_MEASUREMENT_WINDOW 3600 // MEASUREMENT_WINDOW
+#define REPLAY_DATA_INTERVAL      60   // UPDATE_INTERVAL_DATA
+#define REPLAY_HISTORY_COUNT      2880 // DATA_HISTORY_COUNT
+#define REPLAY_HISTORY_COUNT_15M  2976 // DATA_HISTORY_COUNT_15M
+#define REPLAY_HISTORY_COUNT_DAILY 366 // DATA_HISTORY_COUNT_DAILY
+#define REPLAY_SCALE              0.01F // Resolution of the value streams in the binary /data format (dataStreamScale)
+
+const float packedOffsets[REPLAY_STREAMS] = { 0, 0, 0, 1000, 0, NAN, 0, 0, NAN }; // MEASUREMENT_FIXED() offsets, where NAN is a float window
+#define REPLAY_PACKED_RESOLUTION  0.01F // MEASUREMENT_FIXED() resolution
+const char* streamNames[REPLAY_STREAMS] = { "temperature", "humidity", "dew_point", "pressure", "iaq", "gas_resistance", "gas_accuracy", "sound", "light" };
+
+// One sample of every stream, stamped in seconds
+struct Sample
+{
+  int32_t time;
+  float values[REPLAY_STREAMS];
+};
+
+// Discards everything written to it, but counts the bytes
+class CountingWriter : public ResponseWriter
+{
+  public:
+    size_t bytes = 0;
+
+    void write(const char*, size_t size) override { bytes += size; }
+};
+
+// Parse one CSV field, where an empty field, "nan" or "null" is a missing value
+float parseValue(const char* field, const char* end)
+{
+  while (field < end && *field == ' ') field++;
+  if (field == end || !strncmp(field, "nan", 3) || !strncmp(field, "null", 4)) return NAN;
+  return strtof(field, nullptr);
+}
+
+// Read a trace with one sample per line, as "time,temperature,humidity,dew_point,pressure,iaq,gas_resistance,gas_accuracy,sound,light". Times are in
+// seconds, such as epoch times from the flash log. Lines that don't start with a number, such as a header or comments, are skipped.
+bool readTrace(const char* path, std::vector<Sample>& trace)
+{
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+  char line[512];
+  while (fgets(line, sizeof(line), file))
+  {
+    char* p = line;
+    char* end;
+    long t = strtol(p, &end, 10);
+    if (end == p) continue; // Not a sample
+    Sample sample;
+    sample.time = (int32_t)t;
+    for (int s = 0; s < REPLAY_STREAMS; s++)
+    {
+      p = *end == ',' ? end + 1 : end;
+      end = p + strcspn(p, ",\r\n");
+      sample.values[s] = parseValue(p, end);
+    }
+    trace.push_back(sample);
+  }
+  fclose(file);
+  return true;
+}
+
+// Generate the specified number of days of 3-second samples with daily cycles, noise, IAQ calibration at the start, occasional missing values, and
+// large light steps that need the escape words in the binary format
+void syntheticTrace(int days, std::vector<Sample>& trace)
+{
+  std::mt19937 random(1);
+  std::normal_distribution<float> noise(0.0F, 1.0F);
+  std::uniform_real_distribution<float> uniform(0.0F, 1.0F);
+  float pressure = 1013.0F;
+  float sound = 40.0F;
+  int count = days * 24 * 60 * 60 / REPLAY_SAMPLE_INTERVAL;
+  trace.reserve(count);
+  for (int i = 0; i < count; i++)
+  {
+    Sample sample;
+    sample.time = i * REPLAY_SAMPLE_INTERVAL;
+    float day = (float)(sample.time % 86400) / 86400.0F;
+    float t = 21.0F + 3.0F * sinf(2.0F * (float)M_PI * (day - 0.3F)) + 0.05F * noise(random);
+    float h = 45.0F - 10.0F * sinf(2.0F * (float)M_PI * (day - 0.3F)) + 0.2F * noise(random);
+    float g = logf(h / 100.0F) + 17.62F * t / (243.12F + t); // Magnus formula
+    pressure += 0.01F * noise(random);
+    sound += 0.2F * (40.0F - sound) + 2.0F * noise(random) + (uniform(random) < 0.01F ? 25.0F : 0.0F);
+    bool daylight = day > 0.25F && day < 0.8F;
+    bool calibrating = sample.time < 1800;
+
+    sample.values[0] = t;
+    sample.values[1] = h;
+    sample.values[2] = 243.12F * g / (17.62F - g);
+    sample.values[3] = pressure;
+    sample.values[4] = calibrating ? NAN : 60.0F + 20.0F * sinf(2.0F * (float)M_PI * day) + noise(random);
+    sample.values[5] = calibrating ? NAN : 120.0F + 10.0F * noise(random);
+    sample.values[6] = calibrating ? NAN : 3.0F;
+    sample.values[7] = sound;
+    sample.values[8] = daylight ? 5000.0F + 15000.0F * sinf((float)M_PI * (day - 0.25F) / 0.55F) * (uniform(random) < 0.9F ? 1.0F : 0.2F) : 0.5F;
+    if (uniform(random) < 0.001F) sample.values[(int)(uniform(random) * REPLAY_STREAMS) % REPLAY_STREAMS] = NAN; // Dropped reading
+    trace.push_back(sample);
+  }
+}
+
+// Seconds since the specified start time
+double elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Check that the binary encoding of every column of a tier decodes back to the quantized values, and add up the binary and text sizes
+int checkEncoding(const char* name, DataHistory& tier, bool verify, size_t& binaryBytes, size_t& textBytes)
+{
+  int n = tier.size();
+  std::vector<float> values(n);
+  std::vector<int32_t> times(n);
+  std::vector<int16_t> words(n * 3 + 1);
+  std::vector<float> decoded(n);
+  CountingWriter text;
+  int errors = 0;
+
+  for (int i = 0; i < n; i++) times[i] = tier.time(i);
+  int32_t previous = 0;
+  binaryBytes += dataEncodeTimes(words.data(), times.data(), n, previous) * sizeof(int16_t);
+  dataFormatTimes(text, times.data(), n);
+
+  for (int s = 0; s < tier.streams(); s++)
+  {
+    for (int i = 0; i < n; i++) values[i] = tier.value(s, i);
+    previous = 0;
+    int count = dataEncodeValues(words.data(), values.data(), n, REPLAY_SCALE, previous);
+    binaryBytes += count * sizeof(int16_t);
+    dataFormatValues(text, values.data(), n);
+    if (!verify) continue;
+
+    int decodedCount = dataDecodeValues(words.data(), count, REPLAY_SCALE, decoded.data());
+    if (decodedCount != n)
+    {
+      fprintf(stderr, "%s column %d: decoded %d of %d values\n", name, s, decodedCount, n);
+      errors++;
+      continue;
+    }
+    for (int i = 0; i < n; i++)
+    {
+      bool ok = isfinite(values[i]) ? fabsf(decoded[i] - lroundf(values[i] / REPLAY_SCALE) * REPLAY_SCALE) <= 1e-3F * fmaxf(1.0F, fabsf(values[i])) : isnan(decoded[i]);
+      if (!ok && errors++ < 10) fprintf(stderr, "%s column %d element %d: encoded %f, decoded %f\n", name, s, i, values[i], decoded[i]);
+    }
+  }
+  text.flush();
+  textBytes += text.bytes;
+  return errors;
+}
+
+// Check each 15-minute rollup element that is fully covered by the raw tier against a brute-force min/average/max of the raw elements
+int checkRollups(DataHistory& raw, DataHistory& rollup, int32_t period)
+{
+  int errors = 0;
+  int checked = 0;
+  int32_t oldest = raw.size() ? raw.time(0) : 0;
+  for (int e = 0; e < rollup.size(); e++)
+  {
+    int32_t start = rollup.time(e);
+    if (start < oldest) continue;
+    for (int s = 0; s < raw.streams(); s++)
+    {
+      float minimum = INFINITY, maximum = -INFINITY;
+      double sum = 0;
+      int count = 0;
+      for (int i = 0; i < raw.size(); i++)
+      {
+        int32_t t = raw.time(i);
+        float v = raw.value(s, i);
+        if (t < start || t >= start + period || !isfinite(v)) continue;
+        if (v < minimum) minimum = v;
+        if (v > maximum) maximum = v;
+        sum += v;
+        count++;
+      }
+      float expected[DATA_ROLLUP_STATS] = { count ? minimum : NAN, count ? (float)(sum / count) : NAN, count ? maximum : NAN };
+      for (int k = 0; k < DATA_ROLLUP_STATS; k++)
+      {
+        float actual = rollup.value(s * DATA_ROLLUP_STATS + k, e);
+        bool ok = isfinite(expected[k]) ? fabsf(actual - expected[k]) <= 1e-4F * fmaxf(1.0F, fabsf(expected[k])) : isnan(actual);
+        if (!ok && errors++ < 10) fprintf(stderr, "Rollup at %d, stream %d, stat %d: expected %f, got %f\n", (int)start, s, k, expected[k], actual);
+      }
+    }
+    checked++;
+  }
+  printf("Rollups checked:  %d 15-minute elements\n", checked);
+  return errors;
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = nullptr;
+  int days = 0;
+  bool verify = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--synthetic") && i + 1 < argc) days = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--verify")) verify = true;
+    else if (argv[i][0] != '-') path = argv[i];
+    else
+    {
+      fprintf(stderr, "Usage: replay [--verify] (--synthetic <days> | <trace.csv>)\n");
+      return 2;
+    }
+  }
+
+  // Load the trace
+  std::vector<Sample> trace;
+  if (path)
+  {
+    if (!readTrace(path, trace))
+    {
+      fprintf(stderr, "Unable to read %s\n", path);
+      return 1;
+    }
+  }
+  else
+  {
+    syntheticTrace(days > 0 ? days : 7, trace);
+  }
+  if (trace.size() < 2)
+  {
+    fprintf(stderr, "The trace needs at least two samples\n");
+    return 1;
+  }
+  int32_t origin = trace[0].time; // Times are replayed as seconds since the first sample, like the firmware's uptime time index
+  int32_t interval = trace[1].time - trace[0].time > 0 ? trace[1].time - trace[0].time : REPLAY_SAMPLE_INTERVAL;
+  int trackerPoints = REPLAY_MEASUREMENT_WINDOW / interval;
+  printf("Samples:          %zu (%0.1f days at %d seconds)\n", trace.size(), (trace.back().time - origin) / 86400.0, (int)interval);
+
+  // Measurement trackers with every summary operator, and the full-rescan mode as the reference when verifying
+  const uint8_t operators = MEASUREMENT_EMA | MEASUREMENT_QUANTILES | MEASUREMENT_STDDEV | MEASUREMENT_RATE;
+  std::vector<MeasurementTracker*> trackers, references;
+  std::vector<std::vector<float>> tracked(REPLAY_STREAMS); // Every tracked value, for checking the quantile estimates
+  for (int s = 0; s < REPLAY_STREAMS; s++)
+  {
+    trackers.push_back(new MeasurementTracker(trackerPoints, true, operators));
+    references.push_back(verify ? new MeasurementTracker(trackerPoints, false, operators) : nullptr);
+  }
+  int errors = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const Sample& sample : trace)
+  {
+    for (int s = 0; s < REPLAY_STREAMS; s++)
+    {
+      float v = sample.values[s];
+      if (!isfinite(v)) continue; // The firmware doesn't track missing readings
+      trackers[s]->track(v);
+      if (!verify) continue;
+      tracked[s].push_back(v);
+      MeasurementTracker& a = *trackers[s];
+      MeasurementTracker& b = *references[s];
+      b.track(v);
+      if ((a.min != b.min || a.max != b.max || fabsf(a.average - b.average) > 1e-4F * fmaxf(1.0F, fabsf(b.average))) && errors++ < 10)
+      {
+        fprintf(stderr, "Tracker %s at %d: min/avg/max %f/%f/%f, expected %f/%f/%f\n", streamNames[s], (int)(sample.time - origin),
+                a.min, a.average, a.max, b.min, b.average, b.max);
+      }
+      if ((fabsf(a.stddev - b.stddev) > 1e-3F * fmaxf(1.0F, fabsf(b.average)) || !(a.rate == b.rate || (isnan(a.rate) && isnan(b.rate)))) && errors++ < 10)
+      {
+        fprintf(stderr, "Tracker %s at %d: stddev/rate %f/%f, expected %f/%f\n", streamNames[s], (int)(sample.time - origin), a.stddev, a.rate, b.stddev, b.rate);
+      }
+
+      // The quantile estimates only cover data points that are still in the window, so they stay within its min and max (the two estimates are
+      // independent, so p50 can be a little above p95 when the values are close together)
+      MeasurementStats stats = a.stats();
+      float p50 = stats.summary[MEASUREMENT_SUMMARY_P50], p95 = stats.summary[MEASUREMENT_SUMMARY_P95];
+      if ((!(p50 >= a.min && p50 <= a.max) || !(p95 >= a.min && p95 <= a.max)) && errors++ < 10)
+      {
+        fprintf(stderr, "Tracker %s at %d: p50/p95 %f/%f outside of the window min/max %f/%f\n", streamNames[s], (int)(sample.time - origin), p50, p95, a.min, a.max);
+      }
+    }
+  }
+  double trackerSeconds = elapsed(start);
+  printf("Trackers:         %0.1f ns per sample per stream (%d points)%s\n", trackerSeconds * 1e9 / (trace.size() * REPLAY_STREAMS), trackerPoints,
+         verify ? ", checked against full rescans" : "");
+  for (int s = 0; s < REPLAY_STREAMS; s++)
+  {
+    MeasurementStats stats = trackers[s]->stats();
+    printf("  %-15s current %10.2f  min %10.2f  avg %10.2f  max %10.2f  ema %10.2f  p50 %10.2f  p95 %10.2f  stddev %8.2f  rate %8.2f\n", streamNames[s],
+           stats.current, stats.min, stats.average, stats.max, stats.summary[MEASUREMENT_SUMMARY_EMA], stats.summary[MEASUREMENT_SUMMARY_P50],
+           stats.summary[MEASUREMENT_SUMMARY_P95], stats.summary[MEASUREMENT_SUMMARY_STDDEV], stats.summary[MEASUREMENT_SUMMARY_RATE]);
+
+    // The quantile estimates cover the newest half to full window of data points. A quantile q of those points lies between the exact q/2 and
+    // (1 + q)/2 quantiles of the window, which bounds the estimates for every stream, including the ones with a steady trend such as the daily
+    // temperature cycle. The streams without a trend (gas resistance and sound) are also checked against the exact quantiles of the window.
+    // P-square is an estimate, so both checks allow 10% of the window range.
+    int points = verify ? (int)tracked[s].size() : 0;
+    if (points >= trackerPoints)
+    {
+      std::vector<float> window(tracked[s].end() - trackerPoints, tracked[s].end());
+      std::sort(window.begin(), window.end());
+      float range = fmaxf(window.back() - window.front(), 1e-3F);
+      auto exact = [&](float q) { return window[(size_t)(q * (window.size() - 1) + 0.5F)]; };
+      float p50 = stats.summary[MEASUREMENT_SUMMARY_P50], p95 = stats.summary[MEASUREMENT_SUMMARY_P95];
+      bool bounded = p50 >= exact(0.25F) - 0.10F * range && p50 <= exact(0.75F) + 0.10F * range &&
+                     p95 >= exact(0.475F) - 0.10F * range && p95 <= exact(0.975F) + 0.10F * range;
+      bool stationary = s == 5 || s == 7;
+      bool close = !stationary || (fabsf(p50 - exact(0.50F)) <= 0.10F * range && fabsf(p95 - exact(0.95F)) <= 0.10F * range);
+      if ((!bounded || !close) && errors++ < 10)
+      {
+        fprintf(stderr, "Tracker %s quantiles: p50/p95 %f/%f, window quantiles 25/50/75 %f/%f/%f and 47.5/95/97.5 %f/%f/%f\n", streamNames[s], p50, p95,
+                exact(0.25F), exact(0.50F), exact(0.75F), exact(0.475F), exact(0.95F), exact(0.975F));
+      }
+    }
+    delete references[s];
+    references[s] = nullptr;
+  }
+
+  // Repeated data points, like the firmware restoring the flash log, checked against tracking each repeat on its own
+  if (verify)
+  {
+    const int repeats = 10;
+    for (bool incremental : { true, false })
+    {
+      MeasurementTracker a(trackerPoints, incremental, operators), b(trackerPoints, incremental, operators);
+      for (size_t i = 0; i < tracked[0].size(); i += repeats)
+      {
+        a.track(tracked[0][i], repeats);
+        for (int k = 0; k < repeats; k++) b.track(tracked[0][i]);
+      }
+      MeasurementStats x = a.stats(), y = b.stats();
+      bool same = x.min == y.min && x.max == y.max && x.average == y.average && x.summary[MEASUREMENT_SUMMARY_P50] == y.summary[MEASUREMENT_SUMMARY_P50] &&
+                  x.summary[MEASUREMENT_SUMMARY_EMA] == y.summary[MEASUREMENT_SUMMARY_EMA] && x.summary[MEASUREMENT_SUMMARY_RATE] == y.summary[MEASUREMENT_SUMMARY_RATE] &&
+                  fabsf(x.summary[MEASUREMENT_SUMMARY_STDDEV] - y.summary[MEASUREMENT_SUMMARY_STDDEV]) <= 1e-3F;
+      if (!same && errors++ < 10) fprintf(stderr, "Repeated tracking (%s) doesn't match tracking each repeat\n", incremental ? "incremental" : "rescan");
+    }
+  }
+
+  // Missing readings are dropped by track(), so both modes match a full rescan of the same values without them
+  if (verify)
+  {
+    for (bool incremental : { true, false })
+    {
+      MeasurementTracker a(trackerPoints, incremental, operators), b(trackerPoints, false, operators);
+      for (size_t i = 0; i < tracked[0].size(); i++)
+      {
+        if (i % 97 == 0)
+        {
+          a.track(NAN);
+          a.track(INFINITY, 3);
+        }
+        a.track(tracked[0][i]);
+        b.track(tracked[0][i]);
+      }
+      MeasurementStats x = a.stats(), y = b.stats();
+      bool same = x.current == y.current && x.min == y.min && x.max == y.max && fabsf(x.average - y.average) <= 1e-4F * fmaxf(1.0F, fabsf(y.average)) &&
+                  x.summary[MEASUREMENT_SUMMARY_P50] == y.summary[MEASUREMENT_SUMMARY_P50] && x.summary[MEASUREMENT_SUMMARY_EMA] == y.summary[MEASUREMENT_SUMMARY_EMA] &&
+                  fabsf(x.summary[MEASUREMENT_SUMMARY_STDDEV] - y.summary[MEASUREMENT_SUMMARY_STDDEV]) <= 1e-3F;
+      if (!same && errors++ < 10) fprintf(stderr, "Tracking (%s) with missing readings doesn't match a full rescan without them\n", incremental ? "incremental" : "rescan");
+    }
+  }
+
+  // Packed trackers in one arena, like the firmware with MEASUREMENT_PACKED, checked against full rescans of the rounded values
+  MeasurementArena arena;
+  std::vector<MeasurementTracker*> packed;
+  for (int s = 0; s < REPLAY_STREAMS; s++)
+  {
+    bool fixed = !isnan(packedOffsets[s]);
+    packed.push_back(new MeasurementTracker(trackerPoints, arena, fixed ? REPLAY_PACKED_RESOLUTION : 0, fixed ? packedOffsets[s] : 0));
+    if (verify) references[s] = new MeasurementTracker(trackerPoints, false);
+  }
+  std::vector<char> arenaMemory(arena.memoryRequired());
+  arena.begin(arenaMemory.data(), arenaMemory.size());
+  start = std::chrono::steady_clock::now();
+  for (const Sample& sample : trace)
+  {
+    for (int s = 0; s < REPLAY_STREAMS; s++)
+    {
+      float v = sample.values[s];
+      if (!isfinite(v)) continue;
+      packed[s]->track(v);
+      if (!verify) continue;
+      MeasurementTracker& a = *packed[s];
+      MeasurementTracker& b = *references[s];
+      b.track(isnan(packedOffsets[s]) ? v : packedOffsets[s] + lroundf((v - packedOffsets[s]) / REPLAY_PACKED_RESOLUTION) * REPLAY_PACKED_RESOLUTION);
+      if ((a.min != b.min || a.max != b.max || fabsf(a.average - b.average) > 1e-4F * fmaxf(1.0F, fabsf(b.average))) && errors++ < 10)
+      {
+        fprintf(stderr, "Packed tracker %s at %d: min/avg/max %f/%f/%f, expected %f/%f/%f\n", streamNames[s], (int)(sample.time - origin),
+                a.min, a.average, a.max, b.min, b.average, b.max);
+      }
+    }
+  }
+  printf("Packed trackers:  %0.1f ns per sample per stream, %zu arena bytes (%zu unpacked)%s\n", elapsed(start) * 1e9 / (trace.size() * REPLAY_STREAMS),
+         arena.bytesUsed(), (size_t)REPLAY_STREAMS * trackerPoints * (sizeof(float) + 2 * sizeof(uint16_t)), verify ? ", checked against full rescans" : "");
+
+  // Data tiers and rollups, with one raw element per data interval
+  std::vector<char> memory(DataHistory::memoryRequired(REPLAY_HISTORY_COUNT, REPLAY_STREAMS));
+  std::vector<char> memory15m(DataHistory::memoryRequired(REPLAY_HISTORY_COUNT_15M, REPLAY_STREAMS * DATA_ROLLUP_STATS));
+  std::vector<char> memoryDaily(DataHistory::memoryRequired(REPLAY_HISTORY_COUNT_DAILY, REPLAY_STREAMS * DATA_ROLLUP_STATS));
+  DataHistory dataSet, dataSet15m, dataSetDaily;
+  dataSet.begin(memory.data(), REPLAY_HISTORY_COUNT, REPLAY_STREAMS);
+  dataSet15m.begin(memory15m.data(), REPLAY_HISTORY_COUNT_15M, REPLAY_STREAMS * DATA_ROLLUP_STATS);
+  dataSetDaily.begin(memoryDaily.data(), REPLAY_HISTORY_COUNT_DAILY, REPLAY_STREAMS * DATA_ROLLUP_STATS);
+  DataRollup rollup15m(REPLAY_STREAMS, 15 * 60);
+  DataRollup rollupDaily(REPLAY_STREAMS, 24 * 60 * 60);
+  start = std::chrono::steady_clock::now();
+  int32_t next = 0;
+  for (const Sample& sample : trace)
+  {
+    int32_t t = sample.time - origin;
+    if (t < next) continue;
+    next = t - t % REPLAY_DATA_INTERVAL + REPLAY_DATA_INTERVAL;
+    dataSet.append(t, sample.values);
+    rollup15m.add(t, sample.values, dataSet15m);
+    rollupDaily.add(t, sample.values, dataSetDaily);
+  }
+  printf("Data tiers:       %d raw, %d 15-minute, %d daily elements in %0.3f ms\n", dataSet.size(), dataSet15m.size(), dataSetDaily.size(), elapsed(start) * 1e3);
+  if (verify) errors += checkRollups(dataSet, dataSet15m, 15 * 60);
+
+  // Encode every tier in both /data formats
+  start = std::chrono::steady_clock::now();
+  size_t binaryBytes = 0, textBytes = 0;
+  errors += checkEncoding("raw", dataSet, verify, binaryBytes, textBytes);
+  errors += checkEncoding("15m", dataSet15m, verify, binaryBytes, textBytes);
+  errors += checkEncoding("daily", dataSetDaily, verify, binaryBytes, textBytes);
+  printf("Encoding:         %zu binary bytes, %zu text bytes (%0.1f%%) in %0.3f ms%s\n", binaryBytes, textBytes, 100.0 * binaryBytes / textBytes,
+         elapsed(start) * 1e3, verify ? ", round trip checked" : "");
+
+  for (int s = 0; s < REPLAY_STREAMS; s++)
+  {
+    delete trackers[s];
+    delete packed[s];
+    delete references[s];
+  }
+  if (errors)
+  {
+    fprintf(stderr, "%d errors\n", errors);
+    return 1;
+  }
+  return 0;
+}
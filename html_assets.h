@@ -0,0 +1,192 @@
+/**
+ * @file  html_assets.h
+ * @brief Gzip-compressed static web page assets, generated from web/ by tools/gzip_assets.py. Do not edit.
+ */
+
+#ifndef __HTML_ASSETS_H__
+#define __HTML_ASSETS_H__
+
+// web/app.css: 1123 bytes, 376 bytes compressed
+const char htmlAssetCssVersion[] = "3009a5a95b48"; // Content hash, used as the ETag and as the cache-busting URL parameter
+const size_t htmlAssetCssSize = 376;
+const uint8_t htmlAssetCss[] PROGMEM = {
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8D, 0x53, 0xDD, 0x6E, 0x82, 0x30, 0x18, 0xBD, 0xF7, 0x29, 0x9A, 0xEC, 0x56, 0x0C,
+  0x18, 0xCD, 0xB0, 0xBB, 0x32, 0x44, 0xDF, 0xA3, 0xD0, 0x4A, 0x1B, 0x6B, 0x4B, 0xDA, 0x0F, 0x70, 0x5B, 0x7C, 0xF7, 0x01, 0xAD, 0x0E, 0x27, 0x75,
+  0x72, 0xC7, 0xF9, 0xF9, 0xBE, 0x93, 0xD3, 0x16, 0x48, 0x2E, 0xD9, 0xC2, 0x32, 0x65, 0xB5, 0x41, 0xDF, 0x33, 0x84, 0x72, 0x6D, 0x28, 0x33, 0x11,
+  0xE8, 0x0A, 0x23, 0xAB, 0xA5, 0xA0, 0x28, 0xA9, 0xCE, 0x28, 0x97, 0xA4, 0x38, 0x7E, 0xFC, 0xD2, 0x92, 0x1D, 0x60, 0x92, 0x3F, 0x11, 0x53, 0x0A,
+  0xE5, 0x79, 0x52, 0x83, 0x1E, 0x81, 0x46, 0x94, 0xFC, 0x86, 0x5E, 0x66, 0x30, 0x5E, 0x0D, 0x7C, 0x8E, 0xEE, 0x01, 0x3A, 0x8E, 0xE3, 0xAD, 0xE1,
+  0x40, 0xB9, 0x06, 0xD0, 0xA7, 0x09, 0xC5, 0xC3, 0x9E, 0x05, 0x67, 0xA4, 0x73, 0xB8, 0xE9, 0x9D, 0xA4, 0x34, 0xBA, 0x56, 0x34, 0x2A, 0xB4, 0xD4,
+  0x06, 0xA3, 0xB7, 0xB8, 0xFB, 0xB2, 0xAC, 0x9F, 0xEC, 0x91, 0x96, 0x0B, 0x60, 0xFD, 0xFF, 0x41, 0x2B, 0x88, 0xAC, 0xF8, 0x62, 0x18, 0x2D, 0x57,
+  0xD5, 0xF9, 0x06, 0xB5, 0xCC, 0x85, 0xCB, 0xB5, 0xA4, 0x3D, 0x58, 0x11, 0x4A, 0x85, 0x2A, 0x31, 0x5A, 0x77, 0x29, 0x92, 0xD8, 0x29, 0x81, 0x9D,
+  0x21, 0x22, 0x52, 0x94, 0x0A, 0xA3, 0x82, 0x29, 0x60, 0x66, 0x22, 0xDA, 0x90, 0x69, 0xAC, 0xEC, 0x6B, 0x1C, 0x8D, 0xBC, 0xD6, 0xB0, 0x1C, 0x86,
+  0xFE, 0xB5, 0xBB, 0xC2, 0xAE, 0x52, 0x77, 0x02, 0xCB, 0x89, 0xF5, 0xC3, 0x90, 0x47, 0xBB, 0x59, 0xD8, 0x3A, 0x7F, 0xDE, 0x4D, 0x1A, 0xA7, 0xF1,
+  0x7E, 0xFF, 0xDC, 0xEA, 0x63, 0x4C, 0x36, 0xF3, 0x5A, 0x8A, 0x7E, 0xA5, 0xEC, 0xD9, 0x50, 0x8C, 0x5D, 0xBA, 0x4B, 0x03, 0x31, 0x3E, 0x2D, 0xB0,
+  0x53, 0xC8, 0x97, 0xA5, 0x59, 0xC0, 0xA7, 0x18, 0xB4, 0xDA, 0x1C, 0x43, 0xC6, 0x6D, 0xBA, 0x0D, 0x18, 0x0B, 0x2E, 0xAA, 0x90, 0x6B, 0x13, 0x6F,
+  0x7C, 0x5B, 0x64, 0x8E, 0x08, 0x6E, 0x84, 0xED, 0x2E, 0x92, 0x6B, 0xC7, 0x4B, 0x72, 0x59, 0xB3, 0x81, 0xC7, 0x5C, 0x37, 0xBE, 0x76, 0x4F, 0x55,
+  0xB5, 0xA9, 0xE4, 0x40, 0x52, 0xD1, 0x74, 0x6B, 0x88, 0x81, 0xAC, 0xAB, 0x94, 0x08, 0xE5, 0x75, 0xAD, 0xA0, 0xC0, 0x31, 0x4A, 0xD6, 0xB1, 0x3F,
+  0x62, 0xEE, 0xCB, 0x5E, 0xBD, 0xAF, 0x1D, 0xE0, 0x5F, 0xDD, 0xF0, 0x92, 0x57, 0xF1, 0x1D, 0xF6, 0xFF, 0xF3, 0x0C, 0xDD, 0xD8, 0x82, 0xA8, 0x86,
+  0x58, 0x17, 0xE8, 0xA5, 0x1C, 0x97, 0xD9, 0x0F, 0x5B, 0xA0, 0x29, 0xAB, 0x63, 0x04, 0x00, 0x00,
+};
+
+// web/app.js: 13054 bytes, 3719 bytes compressed
+const char htmlAssetJsVersion[] = "a2da5a8df7a9"; // Content hash, used as the ETag and as the cache-busting URL parameter
+const size_t htmlAssetJsSize = 3719;
+const uint8_t htmlAssetJs[] PROGMEM = {
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xE5, 0x5B, 0x6D, 0x73, 0xDB, 0x36, 0x12, 0xFE, 0xAE, 0x5F, 0x81, 0xE4, 0xA6, 0x11,
+  0x19, 0xCB, 0xB2, 0x2C, 0xB7, 0x69, 0xC7, 0xB2, 0x9B, 0x71, 0xEC, 0xB8, 0xF1, 0x8D, 0x53, 0x27, 0xB1, 0xDB, 0x7E, 0x50, 0x35, 0x1E, 0x88, 0x84,
+  0x2C, 0xD6, 0x14, 0xA9, 0x00, 0xA4, 0x65, 0x5D, 0xE2, 0xFF, 0x7E, 0xBB, 0x0B, 0x80, 0x04, 0xA9, 0x97, 0xB3, 0x9D, 0x4C, 0xAE, 0x33, 0xCD, 0x4C,
+  0x14, 0x11, 0x5C, 0x60, 0x5F, 0xB0, 0xFB, 0x60, 0x77, 0xA1, 0x6C, 0x6D, 0xB1, 0x23, 0xAE, 0xC6, 0xC3, 0x94, 0xCB, 0x90, 0x05, 0x63, 0x2E, 0x33,
+  0xD5, 0x66, 0x17, 0x63, 0xC1, 0xA6, 0xFC, 0x4A, 0x30, 0x25, 0x32, 0xC5, 0x84, 0x9A, 0xEE, 0x74, 0x2F, 0xA2, 0x89, 0x60, 0xDE, 0xEB, 0xF3, 0x77,
+  0x3B, 0x5D, 0x18, 0x0D, 0xD2, 0x24, 0x54, 0x2C, 0x48, 0xF3, 0x24, 0x13, 0xD2, 0x67, 0x3C, 0x09, 0x59, 0x26, 0x26, 0xD3, 0xDF, 0x92, 0x08, 0xE8,
+  0xBD, 0xA7, 0xC7, 0x4F, 0x59, 0x2A, 0xD9, 0xD3, 0xC3, 0xA7, 0x3E, 0x1B, 0x8A, 0x51, 0x2A, 0x05, 0xCB, 0xC6, 0x91, 0x62, 0x2A, 0x90, 0xD1, 0x34,
+  0x63, 0xF0, 0x2D, 0x4E, 0x79, 0x28, 0xC2, 0x76, 0xE3, 0x86, 0x4B, 0xCD, 0x74, 0x9B, 0xED, 0xB3, 0x24, 0x8F, 0xE3, 0x96, 0x7E, 0xEC, 0x56, 0x1F,
+  0x77, 0xCC, 0x63, 0xAF, 0x41, 0x33, 0xFE, 0x93, 0xA6, 0x93, 0xB3, 0x69, 0x16, 0xA5, 0x89, 0x82, 0x17, 0x9F, 0x1A, 0x0C, 0x84, 0x4D, 0x76, 0xE9,
+  0x0B, 0x63, 0x22, 0xE1, 0xC3, 0x58, 0x84, 0xBB, 0x6C, 0xC4, 0x63, 0x25, 0x5A, 0x34, 0x36, 0x49, 0x43, 0xB1, 0xCB, 0x9A, 0xB7, 0x4D, 0x78, 0xBA,
+  0xC3, 0x21, 0x5C, 0xC1, 0x4E, 0x98, 0x8D, 0x85, 0x88, 0xE1, 0xA1, 0x9C, 0x99, 0xC9, 0x5C, 0x68, 0x3A, 0x58, 0x39, 0x4A, 0x82, 0xF1, 0xCA, 0xB7,
+  0x95, 0x85, 0x1B, 0x77, 0x46, 0x3E, 0x91, 0xDC, 0x44, 0x32, 0x4D, 0x26, 0x22, 0xC9, 0x78, 0x7C, 0x88, 0x0A, 0x1C, 0xF1, 0x8C, 0x1B, 0x51, 0x43,
+  0xF8, 0x8A, 0x66, 0xDD, 0x65, 0x7D, 0x5A, 0x42, 0x0B, 0xC1, 0x58, 0xCC, 0x87, 0x28, 0x46, 0xF3, 0x9D, 0x14, 0x4A, 0xE5, 0x60, 0x32, 0x6F, 0x32,
+  0xE4, 0xD2, 0x6F, 0xB6, 0xCC, 0xFB, 0x61, 0x2A, 0x43, 0x21, 0x0F, 0xD3, 0x38, 0x95, 0x40, 0x35, 0x8C, 0x73, 0x51, 0xBE, 0xE2, 0xC1, 0xF5, 0x95,
+  0x84, 0xCD, 0x08, 0x97, 0xBE, 0x9E, 0x1F, 0xDC, 0x46, 0xEA, 0xE4, 0x08, 0x86, 0xE7, 0xEF, 0x8A, 0xC1, 0x69, 0x1A, 0x25, 0xD9, 0x07, 0x1E, 0x46,
+  0x39, 0x48, 0xB2, 0x4D, 0x83, 0x46, 0xA7, 0xBA, 0x40, 0x17, 0xB0, 0xB1, 0x42, 0xF2, 0x8C, 0x64, 0x6A, 0xB2, 0x0D, 0x67, 0xA7, 0x37, 0x58, 0x73,
+  0x95, 0x80, 0x52, 0x84, 0x6B, 0xE4, 0x73, 0xDF, 0x3A, 0xE2, 0x5D, 0x3C, 0x42, 0xBC, 0x23, 0x31, 0x63, 0xEF, 0x90, 0xFA, 0x01, 0xC2, 0xFD, 0xAB,
+  0xD3, 0x39, 0x3C, 0xEC, 0x74, 0xD6, 0x08, 0x58, 0xA7, 0xB8, 0x87, 0x90, 0x76, 0x74, 0x1C, 0x85, 0xA1, 0x48, 0x8C, 0x9F, 0x6C, 0x6D, 0xB1, 0x13,
+  0x90, 0x26, 0xE2, 0x71, 0x3C, 0xC7, 0x37, 0x18, 0x09, 0x82, 0x85, 0x20, 0x33, 0x4D, 0x66, 0x57, 0x92, 0x4F, 0xC7, 0x2C, 0x4B, 0xD9, 0xB5, 0x10,
+  0x53, 0x7A, 0x47, 0x0E, 0xCF, 0x46, 0x32, 0x9D, 0x40, 0x94, 0xA4, 0xD7, 0x51, 0x72, 0x05, 0xAF, 0x53, 0x36, 0xCC, 0xD5, 0x5C, 0xC7, 0x59, 0xCA,
+  0x60, 0xB1, 0x74, 0x06, 0x91, 0x95, 0x41, 0xF0, 0x41, 0x50, 0xF1, 0x18, 0x89, 0xD2, 0x84, 0xA6, 0x67, 0xCE, 0x6E, 0xD1, 0xE2, 0xEB, 0x6C, 0xF7,
+  0x26, 0x9F, 0x44, 0x61, 0x94, 0xCD, 0x99, 0xF7, 0xDD, 0x2A, 0x53, 0x5D, 0x49, 0x21, 0x92, 0x35, 0x86, 0xAA, 0xBE, 0x77, 0xCC, 0xF4, 0x66, 0xED,
+  0x5E, 0xC2, 0xE7, 0x60, 0x4D, 0xBC, 0x54, 0xA3, 0x3B, 0x9B, 0x4F, 0x31, 0xCA, 0x40, 0x4D, 0xED, 0xD4, 0xA9, 0x7E, 0x6B, 0x03, 0x18, 0x02, 0x66,
+  0x0A, 0x8F, 0xD1, 0x8D, 0xD0, 0x46, 0x37, 0xA1, 0xC9, 0x81, 0x2B, 0xFC, 0x3D, 0x50, 0x53, 0x11, 0x00, 0x7B, 0x98, 0x52, 0xC1, 0x84, 0x08, 0xA1,
+  0x8B, 0x07, 0xB8, 0xD2, 0x6E, 0x61, 0x18, 0x13, 0xCF, 0x51, 0x12, 0x8A, 0xDB, 0x42, 0x7E, 0xA2, 0x04, 0xCC, 0xCB, 0x2A, 0xF3, 0x8D, 0x49, 0x55,
+  0x06, 0x26, 0xA9, 0xC1, 0xCD, 0x34, 0xCE, 0xAF, 0xA2, 0x52, 0x3E, 0x50, 0x20, 0xCA, 0x62, 0x51, 0x3E, 0x02, 0x08, 0x44, 0x6A, 0x1A, 0xF3, 0x79,
+  0x65, 0x16, 0x11, 0x8A, 0x5B, 0xE0, 0xD2, 0x7C, 0xED, 0x1A, 0x44, 0x35, 0xCD, 0xEB, 0x3B, 0x4B, 0xA7, 0xD1, 0xCB, 0x41, 0xC1, 0x8A, 0x40, 0xE0,
+  0x0F, 0xC2, 0xE1, 0x3D, 0x7F, 0xE7, 0x32, 0x76, 0x4C, 0xC9, 0x65, 0xB3, 0xB5, 0x28, 0x50, 0x69, 0x40, 0xBD, 0x75, 0x2A, 0xD2, 0x16, 0x6A, 0xC6,
+  0x62, 0x94, 0x39, 0x13, 0xB2, 0x28, 0xB8, 0x46, 0x2E, 0x70, 0x08, 0x38, 0x90, 0x53, 0xCA, 0xC8, 0xC0, 0xFB, 0xA2, 0x10, 0x09, 0x42, 0xC9, 0x67,
+  0x67, 0x09, 0x6D, 0xEB, 0x81, 0x14, 0xDC, 0xE8, 0x4C, 0x2E, 0x50, 0xD1, 0x6A, 0x7E, 0xF1, 0x75, 0x04, 0x95, 0xD1, 0xD5, 0x78, 0xAD, 0xA4, 0x08,
+  0x3E, 0x4B, 0xD8, 0xBF, 0xF9, 0x46, 0xEC, 0x75, 0xC4, 0x3C, 0xC6, 0x52, 0x45, 0xE8, 0xC0, 0x5C, 0x1B, 0x3B, 0x11, 0xFF, 0xF8, 0xD0, 0x13, 0xE6,
+  0xE4, 0xE0, 0xFD, 0xD7, 0x3D, 0x55, 0xDE, 0x3F, 0x02, 0xB6, 0x7F, 0xE1, 0x90, 0x28, 0x5C, 0x9F, 0x8D, 0x27, 0xAB, 0x80, 0x27, 0x98, 0xF3, 0x75,
+  0xB8, 0x53, 0x79, 0xED, 0xC8, 0x72, 0xF8, 0x48, 0x59, 0x0E, 0x82, 0x20, 0x07, 0x38, 0x58, 0x07, 0x85, 0xD3, 0x5C, 0x4E, 0xE3, 0x75, 0xF6, 0xA9,
+  0x11, 0x38, 0x52, 0xFD, 0x7E, 0x7F, 0x30, 0xB4, 0x1B, 0xFA, 0x0F, 0x87, 0xC0, 0x83, 0x48, 0xB2, 0xF7, 0x39, 0x1C, 0x6D, 0xD9, 0xFC, 0x0B, 0xF1,
+  0xEF, 0xFD, 0x37, 0xC5, 0xBF, 0x05, 0x58, 0x39, 0xFC, 0x46, 0xB0, 0x42, 0x01, 0xF1, 0x45, 0xF8, 0xFB, 0xFB, 0x37, 0x92, 0xD4, 0x84, 0xC9, 0xD7,
+  0x42, 0x40, 0x25, 0x12, 0x95, 0xCA, 0x87, 0x82, 0xE0, 0x39, 0x06, 0x2E, 0xF3, 0xC2, 0x57, 0x5F, 0x39, 0xC3, 0x3E, 0x7F, 0x04, 0xFE, 0x9C, 0xA2,
+  0xC5, 0x98, 0x17, 0xE7, 0xB7, 0x5F, 0x19, 0x0C, 0x4F, 0xEF, 0x0F, 0x3B, 0x8E, 0x15, 0xFF, 0xE1, 0xC8, 0xA3, 0x3D, 0x03, 0x53, 0x6D, 0xDA, 0x97,
+  0x2F, 0x44, 0x9F, 0xF3, 0xFF, 0x2F, 0xFA, 0x9C, 0x2E, 0x63, 0x9F, 0x5E, 0x71, 0x19, 0x65, 0xE3, 0x49, 0x14, 0xFC, 0x4D, 0x20, 0x68, 0x59, 0x58,
+  0xE7, 0x53, 0x08, 0x61, 0x51, 0xF6, 0x26, 0xF6, 0xD9, 0x28, 0x4F, 0xC8, 0x63, 0x3C, 0xBF, 0x81, 0x3A, 0x8D, 0x44, 0x16, 0x8C, 0xBD, 0xE6, 0x56,
+  0x68, 0x49, 0x9A, 0x3E, 0x8C, 0xB6, 0xA1, 0x08, 0x4A, 0x3C, 0xE3, 0x95, 0x82, 0xED, 0xFF, 0x6C, 0xF4, 0x8F, 0x46, 0xAC, 0x18, 0x6D, 0xA7, 0xD7,
+  0x3E, 0x38, 0x2E, 0xD4, 0x48, 0x09, 0x2B, 0xC6, 0x70, 0xF7, 0x3D, 0xBF, 0x87, 0x42, 0x94, 0xEB, 0x8C, 0xB3, 0x49, 0x5C, 0xAE, 0x11, 0xA6, 0x41,
+  0x8E, 0x39, 0x79, 0xFB, 0x4A, 0x64, 0xAF, 0x63, 0x81, 0x5F, 0x5F, 0xCD, 0x4F, 0x42, 0xAF, 0xE9, 0x88, 0xD0, 0x96, 0x02, 0xCC, 0x18, 0x88, 0x3F,
+  0xC0, 0xC0, 0x5E, 0x31, 0x21, 0x00, 0xAD, 0x33, 0xF1, 0x81, 0x27, 0x57, 0xC2, 0xF3, 0xCD, 0xD3, 0x61, 0x9A, 0x20, 0x4F, 0x38, 0xE3, 0x8E, 0x25,
+  0xBF, 0x42, 0x32, 0x62, 0xE7, 0x1B, 0x19, 0x7A, 0x64, 0x09, 0xA8, 0x1F, 0x8F, 0x44, 0x90, 0x9A, 0xBA, 0x71, 0x18, 0x25, 0x5C, 0xCE, 0xD9, 0x16,
+  0x82, 0x1B, 0x1B, 0xA5, 0x72, 0xC2, 0x33, 0x0C, 0x90, 0x14, 0x8A, 0x3F, 0xC1, 0xB8, 0x94, 0x7C, 0xCE, 0xA6, 0x58, 0x12, 0x66, 0xC0, 0x60, 0xC2,
+  0x3C, 0x25, 0x04, 0x9B, 0x89, 0xE1, 0x1B, 0xF0, 0xE5, 0x58, 0x48, 0x04, 0xC7, 0x57, 0xB4, 0x80, 0xE7, 0xC3, 0x2C, 0x5A, 0x50, 0x5D, 0xA3, 0x11,
+  0x7D, 0x32, 0x78, 0x48, 0x7C, 0x0C, 0x84, 0x16, 0xB6, 0x1E, 0xE6, 0xA3, 0x91, 0x90, 0xDA, 0xE2, 0x48, 0x75, 0x13, 0x41, 0xED, 0xBA, 0xCF, 0x12,
+  0xF8, 0x44, 0xD2, 0xDF, 0xE1, 0xD1, 0xD2, 0xF4, 0x0C, 0x89, 0x66, 0x7F, 0x88, 0xCD, 0x21, 0xA0, 0xC4, 0x09, 0x68, 0xB0, 0xDF, 0x40, 0xD0, 0xED,
+  0x17, 0x5E, 0xB7, 0x45, 0x0E, 0x56, 0x10, 0x13, 0x30, 0x2D, 0xA3, 0xDD, 0xE9, 0x7A, 0xDF, 0xD7, 0x68, 0x61, 0xAF, 0xF2, 0x18, 0xE9, 0x3E, 0x81,
+  0xEF, 0x4D, 0xC0, 0x95, 0x2D, 0xFD, 0x09, 0x91, 0xFF, 0x64, 0xC8, 0x5B, 0x50, 0x68, 0xAB, 0x2C, 0x95, 0x73, 0x5A, 0x76, 0xB7, 0xBE, 0xEA, 0x76,
+  0xB7, 0xA0, 0xD3, 0x92, 0xE2, 0x19, 0x31, 0x60, 0x77, 0x96, 0x4B, 0x3A, 0x1A, 0xC1, 0xC1, 0x01, 0x5C, 0xB6, 0x5F, 0xE0, 0x10, 0x98, 0x99, 0x79,
+  0xA4, 0x16, 0x0C, 0x75, 0x7A, 0xF0, 0xCF, 0x9E, 0xAB, 0x21, 0x0C, 0x6C, 0x6C, 0xA0, 0xC3, 0x68, 0x17, 0x29, 0xF5, 0x5F, 0x54, 0x5D, 0x2F, 0xEC,
+  0xE8, 0x64, 0xC8, 0x11, 0x32, 0x1C, 0xEA, 0xE3, 0x38, 0xE5, 0x28, 0xA7, 0x91, 0x63, 0x83, 0x7D, 0xBF, 0x30, 0x25, 0x8C, 0x6E, 0x22, 0x40, 0x6B,
+  0x98, 0xA4, 0x27, 0xEF, 0xB1, 0x6D, 0xF6, 0x92, 0xBD, 0xE5, 0xD9, 0xB8, 0x4D, 0xE7, 0x82, 0xB7, 0xCD, 0xB6, 0xF4, 0x2B, 0x9F, 0x01, 0xDC, 0xF7,
+  0xB0, 0x0D, 0x71, 0x04, 0x73, 0x42, 0x6C, 0x14, 0x0C, 0xE7, 0x8C, 0xB3, 0xD9, 0x38, 0x85, 0x79, 0x49, 0x3E, 0x19, 0x82, 0xBF, 0x60, 0xEF, 0x41,
+  0xC1, 0xC2, 0x80, 0x21, 0x8A, 0xA9, 0x3C, 0x18, 0x33, 0x48, 0x88, 0x7F, 0xEC, 0xB6, 0xB7, 0x99, 0xB8, 0x05, 0x90, 0x2E, 0xD8, 0xCE, 0xE0, 0x4C,
+  0x52, 0x66, 0xF3, 0x4F, 0x50, 0xA5, 0x03, 0x74, 0x39, 0xB3, 0xFD, 0x2D, 0x56, 0x08, 0x8C, 0x16, 0xAE, 0x19, 0xBD, 0x78, 0x67, 0x37, 0xC9, 0x68,
+  0x63, 0xC7, 0xC1, 0xDA, 0x5D, 0x78, 0x4B, 0x1C, 0xDA, 0xB1, 0x48, 0xAE, 0xB2, 0x31, 0x7B, 0xCE, 0xBA, 0x10, 0x01, 0x96, 0xB9, 0x11, 0x4F, 0x73,
+  0xD7, 0x8C, 0x4B, 0xDF, 0x71, 0x6C, 0xF3, 0x91, 0xB6, 0x89, 0x1E, 0x8B, 0xAD, 0x8B, 0x70, 0xAC, 0xC5, 0x66, 0x7A, 0x07, 0x23, 0xB0, 0x57, 0x39,
+  0x15, 0x9E, 0xF5, 0x06, 0x96, 0xE7, 0xB2, 0xD5, 0x15, 0xC8, 0x49, 0xA0, 0xFE, 0x6C, 0x63, 0x63, 0xD0, 0xB3, 0x07, 0x12, 0x00, 0x89, 0x7E, 0xB9,
+  0xCF, 0x36, 0x77, 0xBA, 0x3F, 0xBE, 0xF8, 0xC9, 0x37, 0x6F, 0x4A, 0xA0, 0xD5, 0xB2, 0xF6, 0xA3, 0x81, 0xED, 0x5B, 0xE2, 0x06, 0xBC, 0x8D, 0x94,
+  0x42, 0xFB, 0xD3, 0xCB, 0x82, 0x34, 0x00, 0x14, 0x88, 0x92, 0x5C, 0xF4, 0x2A, 0x58, 0xB8, 0x84, 0xCD, 0x8F, 0x8B, 0x6C, 0x50, 0x55, 0xCF, 0x48,
+  0x38, 0x60, 0xCF, 0x58, 0xE7, 0xF6, 0x18, 0xFE, 0xF8, 0xEC, 0x73, 0x31, 0x8A, 0x9B, 0x31, 0x60, 0x7B, 0xE0, 0x1F, 0x2F, 0x7C, 0x12, 0xE2, 0x60,
+  0xA8, 0xD2, 0x38, 0xCF, 0x44, 0x4D, 0x8A, 0x19, 0xEE, 0x40, 0xB7, 0x2E, 0x83, 0x00, 0x90, 0x5E, 0xC2, 0x74, 0x43, 0x9B, 0x85, 0xD6, 0x03, 0x4C,
+  0x4F, 0xB0, 0x4F, 0x1C, 0x25, 0x81, 0x86, 0xA8, 0xA9, 0x14, 0x37, 0x51, 0x9A, 0xAB, 0x0A, 0x83, 0xBB, 0xC6, 0xA2, 0x5D, 0x5C, 0xCF, 0xFD, 0x08,
+  0xEE, 0x6A, 0x7D, 0x7A, 0x17, 0x9E, 0x9E, 0xEB, 0xB7, 0xBD, 0x46, 0x39, 0x59, 0xC7, 0x7E, 0xDB, 0x44, 0x6C, 0x5F, 0xFF, 0x8B, 0xEB, 0xE8, 0x35,
+  0x09, 0x33, 0x1B, 0xCC, 0x41, 0x75, 0xA0, 0xEE, 0x15, 0x87, 0x09, 0x02, 0xE6, 0xB9, 0x9E, 0xEA, 0x6E, 0xC9, 0xD9, 0x12, 0xD8, 0x6C, 0x59, 0x6C,
+  0xA4, 0x04, 0x0C, 0x1C, 0xD4, 0x99, 0xFC, 0x2B, 0x9F, 0x08, 0xD5, 0xC2, 0x8E, 0xB1, 0xD4, 0xDA, 0x22, 0x0C, 0x31, 0x4A, 0x58, 0xA8, 0xAB, 0xCD,
+  0x55, 0xD6, 0x28, 0x11, 0xE0, 0x84, 0xC6, 0x01, 0xAD, 0xEE, 0x88, 0x99, 0x5E, 0xC2, 0x50, 0x43, 0x10, 0x26, 0xB0, 0x58, 0xA3, 0xB6, 0x76, 0x1B,
+  0x5C, 0xF6, 0x35, 0x87, 0x63, 0xAD, 0xC0, 0x5F, 0xA4, 0x02, 0xA0, 0xF2, 0x01, 0xF3, 0x9C, 0x55, 0xFB, 0x38, 0x4C, 0x56, 0xEC, 0xD1, 0x51, 0x81,
+  0x4C, 0x51, 0x96, 0x53, 0xCC, 0x28, 0x51, 0xC5, 0xFE, 0x40, 0x0F, 0xBA, 0x48, 0xA8, 0xBD, 0x1F, 0x24, 0xF9, 0x55, 0x87, 0x3D, 0xA8, 0x26, 0xF4,
+  0x29, 0xA6, 0x48, 0x19, 0xDD, 0xDC, 0xD7, 0x60, 0x80, 0xA1, 0x43, 0xDD, 0xC8, 0x5C, 0x4A, 0x20, 0x80, 0xC5, 0x85, 0x6C, 0x18, 0x0C, 0x46, 0x07,
+  0x02, 0xD1, 0x60, 0xB9, 0x26, 0x9C, 0xEB, 0x4D, 0xEB, 0x07, 0x32, 0x23, 0x4B, 0x11, 0xE9, 0x2E, 0x83, 0x37, 0x2D, 0xB6, 0xFD, 0xC3, 0x04, 0x2F,
+  0x02, 0xB6, 0x43, 0x9A, 0x1A, 0x43, 0x92, 0x88, 0x47, 0x0B, 0x9E, 0xFD, 0x34, 0xE9, 0x02, 0x3B, 0xA4, 0xB3, 0x71, 0x14, 0x6B, 0x63, 0x2A, 0x21,
+  0x6F, 0x84, 0xDC, 0x54, 0xC8, 0x4F, 0xDC, 0x90, 0x58, 0x10, 0x1D, 0x89, 0x20, 0x43, 0xA0, 0x7D, 0xD3, 0xA9, 0x48, 0x8C, 0x10, 0x23, 0x90, 0x63,
+  0x6C, 0xCF, 0xAA, 0xFA, 0x82, 0x42, 0x6F, 0xE0, 0xE2, 0x1A, 0xB8, 0x80, 0x08, 0x59, 0x98, 0x4B, 0x6A, 0xAB, 0x02, 0xCD, 0x28, 0x92, 0xCA, 0xC8,
+  0x8D, 0x77, 0x12, 0x60, 0xE9, 0x94, 0x00, 0x86, 0x46, 0x08, 0x24, 0x14, 0x78, 0x88, 0xD0, 0xC9, 0x06, 0x4C, 0xE5, 0x23, 0xEC, 0xB9, 0x46, 0x99,
+  0x4D, 0x9A, 0xB3, 0x0F, 0xAE, 0x3D, 0x8A, 0x5D, 0x23, 0xA7, 0xD4, 0x87, 0x26, 0xED, 0x3C, 0x1A, 0x27, 0x05, 0xE5, 0xD8, 0x0C, 0xD2, 0x02, 0x80,
+  0xDF, 0x11, 0x78, 0x20, 0x31, 0xC4, 0x4D, 0xD0, 0xBA, 0xC7, 0x20, 0x23, 0x30, 0x20, 0x43, 0xB3, 0xAA, 0x99, 0x69, 0xB5, 0x9E, 0x29, 0x6A, 0x6A,
+  0x6E, 0x8C, 0x19, 0x7A, 0x7D, 0xE3, 0x59, 0x91, 0x3C, 0x65, 0xDC, 0x2B, 0x13, 0x89, 0x83, 0x29, 0xA8, 0x1F, 0x2E, 0xA8, 0xE7, 0x2D, 0x4B, 0x1E,
+  0x7C, 0xEC, 0x33, 0x17, 0xED, 0x68, 0xF0, 0x79, 0xCC, 0x87, 0x43, 0x99, 0xEA, 0x1E, 0x75, 0x1A, 0x87, 0x02, 0xCC, 0x06, 0x13, 0xD1, 0x73, 0x20,
+  0x09, 0x29, 0xDD, 0x27, 0x49, 0x41, 0x2F, 0x80, 0x04, 0x70, 0x3D, 0xAE, 0xC8, 0x48, 0x9C, 0xD8, 0xD6, 0xF3, 0x0A, 0x13, 0xC8, 0x85, 0x8D, 0x20,
+  0x1B, 0x02, 0xFB, 0xB8, 0x2B, 0xA1, 0x5A, 0x90, 0xE0, 0x4F, 0xC0, 0x1B, 0x33, 0x5C, 0x14, 0x10, 0xC1, 0xC6, 0x9B, 0x4E, 0x86, 0x64, 0x3A, 0x53,
+  0x64, 0x2C, 0x1D, 0xE1, 0x73, 0x52, 0xBF, 0x79, 0x9E, 0x43, 0x29, 0xD4, 0x7C, 0x9B, 0xE2, 0xE7, 0x05, 0xD6, 0x68, 0xCD, 0x3F, 0xF0, 0xB2, 0xA1,
+  0x79, 0x31, 0xCE, 0xE1, 0xF3, 0x58, 0x46, 0xF0, 0x79, 0xCE, 0xB3, 0xE6, 0xC0, 0x9E, 0xF7, 0x49, 0x8A, 0xE7, 0x02, 0xC8, 0x27, 0xDA, 0xF0, 0xD5,
+  0xD3, 0x38, 0x39, 0x51, 0xE6, 0x6D, 0x6C, 0x0D, 0x5B, 0x45, 0x1E, 0x8A, 0xC2, 0x36, 0x8A, 0x33, 0x68, 0x4F, 0xF8, 0xB4, 0x8C, 0xD7, 0xCC, 0x77,
+  0x32, 0x01, 0xDC, 0x84, 0x32, 0x59, 0x12, 0x1E, 0xB2, 0xDA, 0x64, 0x5E, 0x79, 0xA1, 0xB6, 0xC9, 0x80, 0xFE, 0x39, 0xDB, 0xEE, 0x74, 0x3A, 0xE6,
+  0x08, 0x33, 0x00, 0x86, 0xEA, 0xF4, 0x71, 0x3A, 0x9E, 0xA1, 0x47, 0x70, 0xD6, 0xF9, 0x03, 0xBC, 0xD0, 0x60, 0x78, 0xC5, 0x41, 0xC3, 0x59, 0x7A,
+  0x8A, 0x16, 0xC1, 0x3D, 0x16, 0xE0, 0x12, 0xE0, 0xCF, 0x90, 0x58, 0xAA, 0x38, 0x0A, 0x84, 0xD7, 0x69, 0x6D, 0xFE, 0xE0, 0x2F, 0xA7, 0x46, 0xA6,
+  0x96, 0xDA, 0xA6, 0x99, 0x0D, 0x7D, 0xD8, 0x54, 0x7C, 0x4B, 0x3B, 0x97, 0x5F, 0x73, 0x38, 0x63, 0x02, 0x9C, 0x88, 0x47, 0xC3, 0x9A, 0xD4, 0xC8,
+  0x9E, 0xE1, 0x3A, 0x3B, 0x72, 0x97, 0xE9, 0x2B, 0x84, 0xAD, 0xEA, 0x40, 0x1B, 0x42, 0x34, 0xE0, 0x99, 0x57, 0x98, 0x78, 0xE0, 0x2F, 0xF8, 0x75,
+  0xF9, 0x60, 0xA9, 0xF5, 0xCE, 0x14, 0xC9, 0xA1, 0xB8, 0x0D, 0x84, 0xAA, 0x51, 0x9A, 0x44, 0x62, 0xB3, 0x02, 0x83, 0x3D, 0xA3, 0xB0, 0x99, 0xF0,
+  0x33, 0xEB, 0x94, 0xE9, 0xDB, 0x32, 0x8D, 0x1C, 0x59, 0xD7, 0x69, 0xD5, 0x86, 0xF2, 0x49, 0x5B, 0xDF, 0x88, 0x62, 0x36, 0xD4, 0x11, 0x67, 0x29,
+  0xC5, 0x9D, 0xDD, 0x80, 0x05, 0xB9, 0x4B, 0xB1, 0x6A, 0x2D, 0x8E, 0x76, 0xBC, 0x68, 0x95, 0xDE, 0x52, 0x42, 0xDB, 0x05, 0xE9, 0x77, 0x06, 0xF4,
+  0xBD, 0x6E, 0x7A, 0xC7, 0x97, 0x15, 0x26, 0x8E, 0x97, 0x31, 0x80, 0x66, 0x0C, 0x9F, 0x1F, 0x2F, 0xC3, 0xE1, 0x40, 0x1F, 0x5B, 0x38, 0xBE, 0x7E,
+  0xF1, 0xED, 0xFF, 0xB9, 0x78, 0x8C, 0xA5, 0xA3, 0x5D, 0x3C, 0xBF, 0xD5, 0x2B, 0x53, 0x79, 0xDD, 0x30, 0x97, 0xB6, 0xCB, 0x6E, 0x4C, 0x57, 0xEB,
+  0xB9, 0x82, 0xFE, 0x01, 0xEA, 0x56, 0x56, 0xB8, 0x9C, 0x9A, 0x4B, 0xD7, 0x4B, 0xBC, 0x73, 0xD5, 0xD2, 0xD9, 0x7B, 0xD8, 0x7B, 0xF1, 0xDB, 0x7E,
+  0x20, 0x3F, 0xE7, 0x96, 0x4E, 0x73, 0x73, 0x2E, 0x59, 0xEF, 0xC5, 0xB0, 0xFB, 0x40, 0x86, 0xA1, 0x98, 0x5D, 0x12, 0xDE, 0x6B, 0x76, 0x47, 0xF6,
+  0x02, 0xF2, 0x5E, 0xCC, 0x76, 0x1E, 0xC8, 0x6C, 0x6C, 0xAE, 0x15, 0x35, 0x2F, 0x7B, 0xC9, 0xA8, 0x77, 0xDA, 0xBD, 0xAF, 0x58, 0xBD, 0xBF, 0x15,
+  0xAA, 0x47, 0xEF, 0x2A, 0xAC, 0xA2, 0x45, 0x38, 0x39, 0x78, 0xBF, 0x66, 0xD9, 0x87, 0x6E, 0xDE, 0x15, 0x57, 0x97, 0xE0, 0x1C, 0x00, 0x29, 0x1C,
+  0xB2, 0xDE, 0xCB, 0x74, 0x3C, 0x51, 0x9A, 0xCD, 0x2F, 0x5C, 0xAD, 0x61, 0xD3, 0x7D, 0x04, 0x1B, 0xBC, 0xDB, 0x1D, 0x4A, 0x6C, 0x9F, 0x25, 0x97,
+  0xDC, 0xDC, 0x50, 0x14, 0xBC, 0x98, 0x1D, 0x69, 0x14, 0x1D, 0x0E, 0xFB, 0x5B, 0x0A, 0x83, 0xDF, 0x95, 0xAA, 0x66, 0xE5, 0x2D, 0xAB, 0x15, 0x6B,
+  0xB9, 0x1B, 0xD8, 0xA2, 0xA0, 0xFC, 0x99, 0x06, 0xF8, 0x0E, 0xBD, 0xF5, 0x56, 0xF6, 0x43, 0x88, 0xB6, 0x76, 0x89, 0x09, 0xE5, 0xF6, 0x4A, 0x09,
+  0x7C, 0x37, 0xD3, 0x2F, 0xAA, 0x8E, 0x4F, 0x15, 0xCE, 0x6D, 0x9D, 0xD3, 0x78, 0x15, 0xDA, 0x42, 0xE7, 0xEE, 0x72, 0x9D, 0x6B, 0x97, 0x29, 0x56,
+  0x53, 0x77, 0x83, 0x2A, 0xFA, 0x75, 0x1F, 0xA0, 0x1F, 0x5E, 0xA3, 0x81, 0x52, 0x35, 0x16, 0xF7, 0x50, 0xA5, 0xBB, 0x5E, 0x95, 0x9D, 0xE5, 0xAA,
+  0x2C, 0x36, 0x68, 0xAD, 0x36, 0x35, 0x5C, 0xAE, 0x28, 0xB4, 0xF3, 0x00, 0x85, 0x08, 0xE9, 0x75, 0xCF, 0x13, 0x7B, 0x23, 0x0B, 0xFC, 0xEE, 0xA1,
+  0xDA, 0xCE, 0x12, 0xD5, 0xEE, 0x16, 0x5A, 0x7A, 0xD5, 0x4C, 0xB0, 0xEC, 0x2D, 0x61, 0xFD, 0x44, 0x69, 0x51, 0x25, 0x44, 0xD8, 0xB3, 0x67, 0x2B,
+  0x23, 0x46, 0x27, 0x60, 0xE6, 0x98, 0x7F, 0xB9, 0x9E, 0xAC, 0x7F, 0xAF, 0x45, 0x36, 0xB1, 0x60, 0xDE, 0x2D, 0x72, 0xEB, 0xB2, 0xC9, 0x98, 0xF1,
+  0x97, 0xBA, 0xE3, 0xB6, 0xAF, 0xBB, 0x70, 0xCF, 0xCA, 0x14, 0x7D, 0x1F, 0xF3, 0x2C, 0x27, 0x63, 0xDF, 0x60, 0x5E, 0xA9, 0x8A, 0xDE, 0x4B, 0x10,
+  0xAE, 0xD9, 0x84, 0x75, 0x9B, 0xCF, 0xA8, 0x54, 0xA6, 0x19, 0x96, 0xC6, 0xF7, 0xA9, 0x32, 0xA7, 0xCA, 0xA2, 0xAC, 0x49, 0x74, 0x39, 0x92, 0x26,
+  0xF1, 0x5C, 0x0B, 0x51, 0xCF, 0xDB, 0xBF, 0xA4, 0xD7, 0x49, 0xD9, 0xFE, 0x2B, 0x6A, 0xDB, 0x2C, 0xB4, 0x3C, 0x75, 0x37, 0xA7, 0x5C, 0xCC, 0x96,
+  0xCF, 0xB8, 0x29, 0x45, 0x87, 0xD0, 0x6D, 0xF9, 0x69, 0x7E, 0x85, 0xC2, 0x4F, 0x8C, 0xC2, 0x66, 0xD7, 0xC8, 0xBA, 0x90, 0x45, 0x15, 0xCA, 0x56,
+  0x9C, 0x06, 0x4F, 0xBE, 0x22, 0xE1, 0x97, 0x98, 0xEE, 0x4B, 0x28, 0x82, 0xA8, 0x0A, 0x53, 0xAB, 0x8B, 0x26, 0x33, 0x79, 0x79, 0x35, 0x54, 0xCD,
+  0xB9, 0x8A, 0x8A, 0x08, 0xFF, 0x54, 0xAB, 0x22, 0x3D, 0xA6, 0x4D, 0x53, 0xF1, 0xEC, 0x22, 0x3B, 0xDF, 0x2F, 0x35, 0xD0, 0x04, 0xB5, 0x6A, 0x9A,
+  0xDE, 0x56, 0x53, 0xCB, 0x86, 0xD1, 0xEA, 0xFC, 0x3A, 0x9A, 0x56, 0xAA, 0x2C, 0x2A, 0x93, 0x38, 0x7B, 0x8A, 0x63, 0x4F, 0x75, 0x69, 0xCA, 0x78,
+  0x0C, 0xC2, 0x87, 0x73, 0xC6, 0xC3, 0x10, 0x2A, 0x3F, 0x5B, 0x08, 0x43, 0xA1, 0x2B, 0xC5, 0xC7, 0x1C, 0x0B, 0xAC, 0x19, 0x80, 0x3C, 0x54, 0x3B,
+  0x23, 0x4A, 0x9F, 0x8A, 0xDD, 0xA0, 0xC2, 0xC8, 0xB2, 0x5F, 0x59, 0x96, 0x94, 0x1D, 0x31, 0x34, 0xFD, 0xDF, 0x28, 0xA4, 0x4C, 0xD7, 0x13, 0x0D,
+  0x54, 0x74, 0xEA, 0xB4, 0xEE, 0xE4, 0x44, 0xAE, 0x03, 0x11, 0xD1, 0x9E, 0x56, 0xD8, 0xAE, 0x06, 0xC3, 0xF4, 0xDC, 0xC7, 0x97, 0x03, 0xB6, 0xB7,
+  0x4F, 0xFA, 0xF9, 0x44, 0xBB, 0xB1, 0xA1, 0x97, 0x2B, 0x4B, 0x4E, 0x8F, 0x96, 0x78, 0x59, 0xB1, 0x55, 0xB5, 0x60, 0xB3, 0xF5, 0xEE, 0x27, 0x1B,
+  0x25, 0x7A, 0xC0, 0xD4, 0x52, 0x38, 0xDD, 0xC7, 0x1E, 0x0B, 0x28, 0xE0, 0xAE, 0xE1, 0x78, 0xBE, 0xD3, 0x8C, 0xA8, 0x3A, 0xF7, 0xB2, 0x2E, 0xC5,
+  0x4A, 0x4F, 0xBC, 0xAB, 0x36, 0xFD, 0x3F, 0xE8, 0x5B, 0x04, 0xC2, 0x03, 0xDD, 0xA5, 0x25, 0x4F, 0xE0, 0xAC, 0xB8, 0x6A, 0x60, 0x50, 0xFE, 0xEA,
+  0xC8, 0x40, 0x60, 0xD0, 0x5D, 0x30, 0xEA, 0x5D, 0x51, 0xDF, 0xAA, 0x45, 0x7D, 0x1C, 0xDB, 0xE5, 0x48, 0x8A, 0x86, 0x0F, 0x84, 0x70, 0x34, 0x81,
+  0x42, 0x9A, 0x56, 0x57, 0xFA, 0x07, 0x65, 0x40, 0x90, 0xD3, 0x2F, 0xE6, 0xB0, 0x21, 0xC4, 0x01, 0x69, 0xA0, 0xAE, 0x77, 0xF0, 0xFA, 0x03, 0xD5,
+  0xC7, 0x85, 0xBD, 0x22, 0x08, 0x4F, 0xCD, 0xAD, 0x04, 0x6E, 0x49, 0x24, 0xAB, 0x4E, 0x97, 0x28, 0xF4, 0x6D, 0xCD, 0xF5, 0x04, 0x28, 0x7D, 0x27,
+  0xE6, 0x70, 0xF2, 0xB5, 0x75, 0x83, 0xA2, 0xF8, 0x0A, 0xB0, 0xF9, 0xDE, 0x83, 0x7F, 0xF6, 0x70, 0xE5, 0x76, 0x20, 0xE2, 0xD8, 0xDD, 0xFE, 0x6B,
+  0x18, 0xD7, 0x12, 0x14, 0xF5, 0x58, 0x80, 0xF5, 0x98, 0x01, 0x13, 0x0D, 0x9F, 0x38, 0x09, 0x7B, 0x46, 0xA8, 0x1D, 0x8A, 0x37, 0x86, 0x48, 0x03,
+  0x73, 0x54, 0x1A, 0xF5, 0x44, 0xB3, 0x5F, 0xF2, 0xE8, 0x07, 0x26, 0x6A, 0xF0, 0xA9, 0x1D, 0x25, 0x89, 0x90, 0x6F, 0x2E, 0xDE, 0x9E, 0x02, 0x49,
+  0x75, 0xC0, 0xDE, 0xF1, 0x78, 0x5B, 0x9B, 0x2F, 0xBD, 0x3F, 0xC3, 0x0D, 0xEF, 0xCF, 0x36, 0x7C, 0xFA, 0x2F, 0x3F, 0x27, 0x3C, 0xF9, 0x1C, 0x25,
+  0x23, 0x7F, 0xEB, 0xAA, 0x55, 0x1A, 0x4C, 0x1B, 0xDF, 0x2F, 0x73, 0x12, 0xB0, 0xC3, 0x35, 0xFB, 0x79, 0xBF, 0xAA, 0x43, 0x01, 0xD2, 0x9A, 0xBC,
+  0xE7, 0xB4, 0xA2, 0x89, 0xAE, 0xE8, 0x74, 0xF6, 0xAF, 0x9D, 0x66, 0x34, 0x81, 0x73, 0x9A, 0x11, 0xFC, 0xE1, 0xB4, 0x36, 0x75, 0x17, 0xCF, 0x46,
+  0x5E, 0xB3, 0xDD, 0xAC, 0x41, 0x9C, 0x5D, 0xA6, 0x3C, 0x8F, 0x12, 0xBC, 0xAD, 0xDB, 0xD5, 0xE3, 0xED, 0x2C, 0x3D, 0x8E, 0x6E, 0x45, 0xE8, 0xE1,
+  0x6A, 0x7B, 0xAC, 0x03, 0xEF, 0x3B, 0x14, 0xB3, 0xB4, 0x6A, 0x11, 0xC8, 0xF8, 0x16, 0xC2, 0xD9, 0xFA, 0xAC, 0x29, 0x60, 0x8D, 0xCF, 0x9E, 0x2F,
+  0xF6, 0xEF, 0x0A, 0xFF, 0x2C, 0xDD, 0xD6, 0xF4, 0xF1, 0xD1, 0xF3, 0x82, 0xB2, 0x69, 0x68, 0x5B, 0x6D, 0x0A, 0xA0, 0x1F, 0x4E, 0x50, 0xEE, 0x76,
+  0x24, 0xC7, 0xFA, 0x69, 0xE1, 0x42, 0xEB, 0x35, 0xF1, 0x58, 0x7E, 0x99, 0x65, 0x9A, 0x7E, 0x9A, 0x64, 0x31, 0xDB, 0x20, 0x5F, 0x9C, 0x81, 0xB1,
+  0x60, 0xEB, 0x89, 0x06, 0x72, 0x1F, 0x19, 0x88, 0xBA, 0x6B, 0x0A, 0x3B, 0x1D, 0x55, 0x70, 0xE8, 0x20, 0x21, 0xD0, 0xAF, 0xB4, 0x91, 0xF5, 0xF7,
+  0x76, 0x9A, 0x60, 0x7F, 0xB1, 0xC2, 0xCC, 0x6C, 0xBA, 0xE9, 0x7C, 0xE2, 0xC5, 0x47, 0x89, 0x1B, 0x2E, 0x1E, 0x3F, 0xB1, 0x0D, 0x97, 0x0A, 0x30,
+  0xE8, 0x2E, 0x4B, 0x15, 0x46, 0x68, 0x0D, 0x74, 0xF5, 0x63, 0x4A, 0x0A, 0xE8, 0xD7, 0xA4, 0x8E, 0x01, 0xE9, 0x77, 0xA3, 0xC5, 0x6F, 0xAE, 0x8B,
+  0x1E, 0x68, 0x71, 0xB0, 0x02, 0xD0, 0x9A, 0x59, 0xE6, 0x4D, 0x98, 0x26, 0x4D, 0xBC, 0x44, 0x0C, 0xE2, 0x3C, 0xC4, 0x84, 0xEE, 0xAE, 0xA2, 0x90,
+  0x90, 0x92, 0xAE, 0x99, 0x5C, 0x8D, 0x6A, 0x7D, 0x5C, 0xDD, 0xDC, 0xBE, 0x28, 0x1B, 0x72, 0x20, 0xB0, 0xB1, 0xBE, 0xC2, 0x1F, 0xA5, 0x12, 0xB0,
+  0xCC, 0x92, 0x56, 0x81, 0x35, 0xF4, 0xC3, 0xF2, 0x69, 0x0A, 0xF1, 0x66, 0x37, 0x6E, 0x22, 0x78, 0x82, 0x98, 0x5E, 0x72, 0x86, 0x13, 0x91, 0xCC,
+  0x7D, 0x0A, 0x87, 0xAB, 0x00, 0x29, 0xBC, 0x26, 0x32, 0x6D, 0x3A, 0x51, 0x25, 0xDC, 0x3E, 0x1B, 0x32, 0x06, 0x89, 0xFE, 0x7D, 0x7E, 0xF6, 0x6B,
+  0x7B, 0xCA, 0xA5, 0x12, 0x9E, 0xA0, 0xE4, 0xD8, 0xAF, 0xDF, 0x03, 0x85, 0xC8, 0x12, 0xA9, 0x7D, 0xDA, 0x02, 0x40, 0xA6, 0x12, 0xE4, 0x08, 0xD9,
+  0xF0, 0x5D, 0x3F, 0x0A, 0x07, 0x45, 0x77, 0x6C, 0x8D, 0x48, 0xC8, 0x61, 0xA5, 0x48, 0xA6, 0xB3, 0xBE, 0x46, 0x2A, 0x93, 0xA5, 0xD9, 0xA4, 0xF1,
+  0x89, 0x69, 0xA7, 0xB3, 0xCF, 0x9F, 0xD9, 0xB2, 0x5E, 0x5C, 0xE5, 0x68, 0xA9, 0xBA, 0x09, 0x9E, 0x17, 0x60, 0xCF, 0x7C, 0x4A, 0xDD, 0x63, 0xA5,
+  0x93, 0xC6, 0x40, 0xDF, 0xCC, 0x98, 0xE6, 0x2C, 0x36, 0x7E, 0x2D, 0xBC, 0x4F, 0x85, 0x8C, 0x52, 0x9D, 0x64, 0xFD, 0x95, 0x23, 0x54, 0x8E, 0x45,
+  0x70, 0x4D, 0x46, 0x42, 0x37, 0xB7, 0x57, 0x02, 0x2B, 0xF3, 0xA3, 0x9A, 0xEF, 0xAE, 0x3E, 0xF7, 0x01, 0xAA, 0xCD, 0x62, 0xED, 0x0C, 0xCF, 0xE9,
+  0xAF, 0x94, 0x4A, 0x14, 0x41, 0x4A, 0x59, 0xB3, 0x49, 0xA1, 0xC6, 0x1C, 0x7C, 0x32, 0xCA, 0x16, 0x12, 0xB8, 0x42, 0x80, 0x5E, 0xED, 0x7A, 0x56,
+  0x39, 0x2F, 0x6F, 0xAA, 0x19, 0xC1, 0x8D, 0x93, 0x0C, 0xF4, 0x6F, 0x06, 0x3D, 0xE3, 0x07, 0xAC, 0xE8, 0x6D, 0x4E, 0x73, 0x35, 0xF6, 0xFA, 0xC5,
+  0xD2, 0x03, 0x7F, 0x31, 0xEB, 0x70, 0xB2, 0x04, 0x7B, 0xAA, 0x17, 0xC7, 0xE3, 0xA2, 0x27, 0x1D, 0x9D, 0xBD, 0xA5, 0x5F, 0x03, 0xC0, 0x18, 0xFD,
+  0xC7, 0x08, 0xD7, 0xAB, 0xB4, 0x53, 0xD5, 0x13, 0x86, 0x0A, 0xBE, 0x79, 0x45, 0x13, 0x74, 0x12, 0x25, 0x79, 0x26, 0x94, 0x3D, 0x51, 0x15, 0x5D,
+  0x8D, 0x03, 0x2C, 0xF3, 0xD8, 0x5B, 0x00, 0x25, 0xEC, 0x71, 0x81, 0xD7, 0x38, 0x17, 0x30, 0x4B, 0x2F, 0x5D, 0x00, 0x22, 0x13, 0xFD, 0x3F, 0x42,
+  0xD4, 0x1C, 0xE4, 0x9D, 0x50, 0x1C, 0x27, 0x22, 0x9B, 0xA5, 0xF2, 0x5A, 0x07, 0x1E, 0x97, 0x02, 0x31, 0x04, 0xAD, 0x62, 0x72, 0x77, 0x5C, 0x4C,
+  0xDF, 0x30, 0x97, 0xB8, 0x4F, 0x69, 0x2D, 0x21, 0x19, 0xE4, 0xBA, 0xC0, 0x49, 0xCE, 0xD9, 0x76, 0xC7, 0x0A, 0xDC, 0xD6, 0xBF, 0x1A, 0xD2, 0x0F,
+  0x36, 0x8B, 0x23, 0x90, 0x26, 0xB0, 0x81, 0x90, 0xB0, 0x9A, 0x7D, 0x87, 0xB3, 0x20, 0x26, 0x3A, 0x7E, 0xFD, 0x17, 0x22, 0x9E, 0x5F, 0x9B, 0xE6,
+  0x2F, 0x58, 0xED, 0xAE, 0xC5, 0x5E, 0x74, 0x9E, 0x9B, 0x6E, 0x3B, 0xEE, 0xCB, 0x7F, 0x01, 0xE1, 0xB5, 0x78, 0x9C, 0xFE, 0x32, 0x00, 0x00,
+};
+
+#endif
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Compress the static web page assets in web/ into html_assets.h, which the sketch serves with Content-Encoding: gzip.
+
+Run this after editing anything in web/, and commit the regenerated header along with the change:
+    python3 tools/gzip_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Source file, C identifier prefix
+ASSETS = [
+    ("web/app.css", "htmlAssetCss"),
+    ("web/app.js", "htmlAssetJs"),
+]
+
+
+def main():
+    lines = [
+        "/**",
+        " * @file  html_assets.h",
+        " * @brief Gzip-compressed static web page assets, generated from web/ by tools/gzip_assets.py. Do not edit.",
+        " */",
+        "",
+        "#ifndef __HTML_ASSETS_H__",
+        "#define __HTML_ASSETS_H__",
+        "",
+    ]
+    for path, name in ASSETS:
+        with open(os.path.join(ROOT, path), "rb") as f:
+            source = f.read()
+        data = gzip.compress(source, compresslevel=9, mtime=0)  # A fixed timestamp keeps the output the same for the same input
+        version = hashlib.sha1(source).hexdigest()[:12]
+        lines.append(f"// {path}: {len(source)} bytes, {len(data)} bytes compressed")
+        lines.append(f'const char {name}Version[] = "{version}"; // Content hash, used as the ETag and as the cache-busting URL parameter')
+        lines.append(f"const size_t {name}Size = {len(data)};")
+        lines.append(f"const uint8_t {name}[] PROGMEM = {{")
+        for i in range(0, len(data), 24):
+            lines.append("  " + ", ".join(f"0x{b:02X}" for b in data[i:i + 24]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("#endif")
+    with open(os.path.join(ROOT, "html_assets.h"), "w", newline="\n") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,444 @@
+// Dashboard charts. The page sets esp32Time (ESP32 seconds counter) and tempUnits ("F" or "C") before this script is loaded.
+var chart1 = null, chart2 = null, chart3 = null;
+
+var zoomOptions = {
+  pan: {
+    enabled: false,
+    mode: 'x'
+  },
+  zoom: {
+    wheel: { enabled: true },
+    pinch: { enabled: true },
+    mode: 'x'
+  }
+};
+
+var environmentalChartData = {
+  datasets: [
+    {
+      label: 'Pressure (mbar)',
+      borderColor: 'blue',
+      backgroundColor: 'blue',
+      yAxisID: 'yP',
+      pointRadius: 1
+    },
+    {
+      label: 'Temperature (' + tempUnits + ')',
+      borderColor: 'red',
+      backgroundColor: 'red',
+      yAxisID: 'yT',
+      pointRadius: 1
+    },
+    {
+      label: 'Dew Point (' + tempUnits + ')',
+      borderColor: '#00CC00',
+      backgroundColor: '#00CC00',
+      yAxisID: 'yT',
+      pointRadius: 1,
+      hidden: true // Initially hide the dew point graph to keep the chart from looking too busy and to allow better scaling on the temperature graph
+    },
+    {
+      label: 'Humidity (%)',
+      borderColor: 'green',
+      backgroundColor: 'green',
+      yAxisID: 'yH',
+      pointRadius: 1
+    }
+  ]
+};
+
+var environmentalChartOptions = {
+  type: 'line',
+  options: {
+    responsive: true,
+    maintainAspectRatio: false,
+    interaction: {
+      mode: 'index',
+      intersect: false,
+    },
+    stacked: false,
+    plugins: {
+      title: {
+        display: false,
+        text: 'Environmentals'
+      },
+      zoom: zoomOptions
+    },
+    scales: {
+      yP: {
+        type: 'linear',
+        display: true,
+        position: 'left',
+        ticks: { color: 'blue' },
+        grid: { drawOnChartArea: false }
+      },
+      yT: {
+        type: 'linear',
+        display: true,
+        position: 'right',
+        ticks: { color: 'red' }
+      },
+      yH: {
+        type: 'linear',
+        display: true,
+        position: 'right',
+        ticks: { color: 'green' },
+        grid: { drawOnChartArea: false }
+      }
+    }
+  },
+};
+
+var iaqChartData = {
+  datasets: [
+    {
+      label: 'IAQ',
+      borderColor: 'blue',
+      backgroundColor: 'blue',
+      yAxisID: 'yQ',
+      pointRadius: 1
+    },
+    {
+      label: 'Gas (kOhm)',
+      borderColor: 'cyan',
+      backgroundColor: 'cyan',
+      yAxisID: 'yC',
+      pointRadius: 1
+    },
+    {
+      label: 'Gas Accuracy (%)',
+      borderColor: 'purple',
+      backgroundColor: 'purple',
+      yAxisID: 'yV',
+      pointRadius: 1
+    }
+  ]
+};
+
+var iaqChartOptions = {
+  type: 'line',
+  options: {
+    responsive: true,
+    maintainAspectRatio: false,
+    interaction: {
+      mode: 'index',
+      intersect: false,
+    },
+    stacked: false,
+    plugins: {
+      title: {
+        display: false,
+        text: 'Air Quality'
+      },
+      zoom: zoomOptions
+    },
+    scales: {
+      yQ: {
+        type: 'linear',
+        display: true,
+        position: 'left',
+        ticks: { color: 'blue' }
+      },
+      yC: {
+        type: 'linear',
+        display: true,
+        position: 'right',
+        ticks: { color: 'cyan' },
+        grid: { drawOnChartArea: false }
+      },
+      yV: {
+        type: 'linear',
+        display: true,
+        position: 'right',
+        ticks: { color: 'purple' },
+        grid: { drawOnChartArea: false }
+      }
+    }
+  },
+};
+
+var sensorChartData = {
+  datasets: [
+    {
+      label: 'Sound (dB)',
+      borderColor: 'blue',
+      backgroundColor: 'blue',
+      yAxisID: 'yS',
+      pointRadius: 1
+    },
+    {
+      label: 'Light (lux)',
+      borderColor: 'cyan',
+      backgroundColor: 'cyan',
+      yAxisID: 'yL',
+      pointRadius: 1
+    }
+  ]
+};
+
+var sensorChartOptions = {
+  type: 'line',
+  options: {
+    responsive: true,
+    maintainAspectRatio: false,
+    interaction: {
+      mode: 'index',
+      intersect: false,
+    },
+    stacked: false,
+    plugins: {
+      title: {
+        display: false,
+        text: 'Sound and Light'
+      },
+      zoom: zoomOptions
+    },
+    scales: {
+      yS: {
+        type: 'linear',
+        display: true,
+        position: 'left',
+        ticks: { color: 'blue' }
+      },
+      yL: {
+        type: 'logarithmic',
+        display: true,
+        position: 'right',
+        ticks: { color: 'cyan' },
+        grid: { drawOnChartArea: false }
+      }
+    }
+  },
+};
+
+var updateDashboard = function()
+{
+  fetch('/dashboard')
+  .then(response => {
+    if (response.ok) return response.text();
+  })
+  .then(html => {
+    document.getElementById('dashboard').replaceWith(document.createRange().createContextualFragment(html));
+  });
+};
+
+// Decode the binary /data format into one array per stream (see webHandlerDataBinary() in the sketch)
+var decodeData = function(buffer)
+{
+  var view = new DataView(buffer);
+  var streamCount = view.getUint16(2, true);
+  var pointCount = view.getUint32(4, true);
+  var result = { time: view.getInt32(8, true), historyCount: view.getUint32(12, true), streams: [] };
+  var offset = 16;
+  for (var s = 0; s < streamCount; s++)
+  {
+    var stream = view.getUint16(offset, true);
+    var scale = view.getFloat32(offset + 4, true);
+    var divisor = scale < 1 ? Math.round(1 / scale) : 1; // Dividing by a whole number keeps values such as 72.1 exact
+    var words = new Int16Array(buffer, offset + 12, view.getUint32(offset + 8, true));
+    offset += 12 + words.length * 2;
+
+    var values = new Array(pointCount);
+    var q = 0;
+    for (var i = 0, w = 0; i < pointCount; i++)
+    {
+      var word = words[w++];
+      if (word == -32768)
+      {
+        values[i] = null; // Missing value
+        continue;
+      }
+      if (word == -32767)
+      {
+        q = (words[w] & 0xFFFF) | (words[w + 1] << 16); // Absolute value
+        w += 2;
+      }
+      else
+      {
+        q += word; // Change since the previous value
+      }
+      values[i] = scale < 1 ? q / divisor : q * scale;
+    }
+    result.streams[stream] = values;
+  }
+  return result;
+};
+
+var dataStreams = null; // One array per stream, in the order of dataStreamNames, where the time index is last
+var streamIndex = {}; // Stream index by name
+dataStreamNames.forEach(function(name, s) { streamIndex[name] = s; });
+var timeLabels = [];
+var historyCount = 0; // Number of elements the ESP32 keeps for the current tier
+var resolution = 'raw'; // Chart data tier: raw, 15m or 1d
+var live = false; // True while the server-sent events connection is open
+var refreshData = false; // True when the events connection opened during the first data load, so new data points are fetched after it
+
+var setResolution = function(value)
+{
+  // Start over with a full load of the selected tier
+  resolution = value;
+  dataStreams = null;
+  timeLabels = [];
+  updateData();
+};
+
+// Append new data points (one array per stream) to the charts, and drop the oldest ones that the ESP32 no longer has
+var appendData = function(streams)
+{
+  // Convert the ESP32 timestamps to local time in the browser
+  var days = ['Sun','Mon','Tue','Wed','Thu','Fri','Sat'];
+  var now = Date.now(); // ms
+  var labels = streams[streamIndex.time].map(function(t) {
+    var date = new Date(now - (esp32Time - t) * 1000);
+    return days[date.getDay()] + ' ' + date.toLocaleDateString().slice(0,-5) + ' ' + date.toLocaleTimeString();
+  });
+
+  if (dataStreams == null) dataStreams = streams;
+  else for (var s = 0; s < streams.length; s++) dataStreams[s] = dataStreams[s].concat(streams[s]);
+  timeLabels = timeLabels.concat(labels);
+  var excess = timeLabels.length - historyCount;
+  if (excess > 0)
+  {
+    for (var s = 0; s < dataStreams.length; s++) dataStreams[s].splice(0, excess);
+    timeLabels.splice(0, excess);
+  }
+
+  if (timeLabels.length)
+  {
+    sensorChartData.labels = timeLabels;
+    sensorChartData.datasets[0].data = dataStreams[streamIndex.sound_level_leq_db]; // Sound
+    sensorChartData.datasets[1].data = dataStreams[streamIndex.light_level_lux]; // Light
+
+    environmentalChartData.labels = timeLabels;
+    environmentalChartData.datasets[0].data = dataStreams[streamIndex.environmental_pressure_mbar]; // Pressure
+    environmentalChartData.datasets[1].data = dataStreams[streamIndex.environmental_temperature]; // Temperature
+    environmentalChartData.datasets[2].data = dataStreams[streamIndex.environmental_dew_point]; // Dew point
+    environmentalChartData.datasets[3].data = dataStreams[streamIndex.environmental_humidity]; // Humidity
+
+    iaqChartData.labels = timeLabels;
+    iaqChartData.datasets[0].data = dataStreams[streamIndex.environmental_iaq]; // IAQ
+    iaqChartData.datasets[1].data = dataStreams[streamIndex.environmental_gas_resistance_ohms]; // Gas
+    iaqChartData.datasets[2].data = dataStreams[streamIndex.environmental_gas_calibration_accuracy]; // Gas accuracy
+
+    if (chart1 == null)
+    {
+      environmentalChartOptions.data = environmentalChartData;
+      chart1 = new Chart(document.getElementById('chartEnvironmentals'), environmentalChartOptions);
+    }
+    else
+    {
+      chart1.update();
+    }
+    if (chart2 == null)
+    {
+      iaqChartOptions.data = iaqChartData;
+      chart2 = new Chart(document.getElementById('chartIAQ'), iaqChartOptions);
+    }
+    else
+    {
+      chart2.update();
+    }
+    if (chart3 == null)
+    {
+      sensorChartOptions.data = sensorChartData;
+      chart3 = new Chart(document.getElementById('chartSoundLight'), sensorChartOptions);
+    }
+    else
+    {
+      chart3.update();
+    }
+  }
+};
+
+var updateData = function()
+{
+  var lastTime = dataStreams && dataStreams[streamIndex.time].length ? dataStreams[streamIndex.time][dataStreams[streamIndex.time].length - 1] : null;
+  fetch('/data?format=binary&resolution=' + resolution + (lastTime == null ? '' : '&since=' + lastTime)) // After the first load, only fetch new data points
+  .then(response => {
+    if (response.ok) return response.arrayBuffer();
+  })
+  .then(buffer => {
+    var data = decodeData(buffer);
+    if (lastTime != null && data.time < lastTime)
+    {
+      // The ESP32 restarted, so start over with a full load
+      dataStreams = null;
+      timeLabels = [];
+      updateData();
+      return;
+    }
+    esp32Time = data.time;
+    historyCount = data.historyCount;
+
+    // Skip data points that a "data" event already added while this request was in flight
+    var times = data.streams[streamIndex.time];
+    var last = dataStreams && dataStreams[streamIndex.time].length ? dataStreams[streamIndex.time][dataStreams[streamIndex.time].length - 1] : null;
+    var skip = 0;
+    while (last != null && skip < times.length && times[skip] <= last) skip++;
+    appendData(skip ? data.streams.map(function(stream) { return stream.slice(skip); }) : data.streams);
+    if (refreshData)
+    {
+      refreshData = false;
+      updateData();
+    }
+  });
+};
+
+// Replace the numbers in a dashboard row with new values, in order, keeping the number of decimal places and the units of each one
+var updateRow = function(id, values)
+{
+  var row = document.getElementById(id);
+  if (!row) return;
+  var k = 0;
+  for (var c = 1; c < row.cells.length && k < values.length; c++) // The first cell is the row heading
+  {
+    var cell = row.cells[c];
+    cell.innerHTML = cell.innerHTML.replace(/-?(\d+(\.\d+)?|nan|inf)/g, function(number) {
+      if (k >= values.length) return number;
+      var value = values[k++];
+      var dot = number.indexOf('.');
+      return value == null ? 'nan' : value.toFixed(dot < 0 ? 0 : number.length - dot - 1);
+    });
+  }
+};
+
+// Server-sent events with new dashboard values and chart data points as soon as the ESP32 has them (see webHandlerEvents() in the sketch)
+var connectEvents = function()
+{
+  if (!window.EventSource) return;
+  var events = new EventSource('/events');
+  events.onopen = function() {
+    live = true;
+    if (dataStreams != null) updateData(); else refreshData = true; // Fetch the data points from before the events started, which the events don't include
+  };
+  events.onerror = function() { live = false; }; // The browser reconnects on its own, and the page polls in the meantime
+  events.addEventListener('live', function(e) {
+    var rows = JSON.parse(e.data);
+    for (var id in rows) if (id) updateRow(id, rows[id]);
+  });
+  events.addEventListener('data', function(e) {
+    var element = JSON.parse(e.data);
+    if (resolution != 'raw' || dataStreams == null)
+    {
+      updateData(); // Rollup tiers only change at the end of each period, so just check for new elements
+      return;
+    }
+    if (dataStreams[streamIndex.time].length && element.t <= dataStreams[streamIndex.time][dataStreams[streamIndex.time].length - 1]) return; // Already have it
+    esp32Time = element.t;
+    var streams = element.v.map(function(v) { return [v]; });
+    streams.push([element.t]);
+    appendData(streams);
+  });
+};
+
+document.addEventListener('DOMContentLoaded', function() {
+  updateData();
+  connectEvents();
+  var minutes = 0;
+  setInterval(function() {
+    // Poll while the events connection is down. The system and network rows aren't pushed, so the whole dashboard is refreshed every 10 minutes.
+    minutes++;
+    if (!live || minutes % 10 == 0) updateDashboard();
+    if (!live) updateData();
+  }, 60*1000);
+});